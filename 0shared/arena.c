@@ -0,0 +1,251 @@
+/*--------------------------------------------------------------------*/
+/* arena.c                                                            */
+/* Author: Roy Mazumder and Roshaan Khalid                            */
+/*--------------------------------------------------------------------*/
+
+#include "arena.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The granularity of block sizes, which is also the alignment of
+   every block. */
+
+#define ALIGNMENT 16
+
+/* The largest block size that is carved from a slab.  Larger blocks
+   get their own allocation. */
+
+#define MAX_SMALL_SIZE 1024
+
+/* The number of size classes of small blocks. */
+
+#define NUM_CLASSES (MAX_SMALL_SIZE / ALIGNMENT)
+
+/* The number of bytes of a slab, including its header. */
+
+static const size_t SLAB_SIZE = 64 * 1024;
+
+/*--------------------------------------------------------------------*/
+
+/* A Header starts every slab and every large block, linking it into
+   its list.  Its size is a multiple of ALIGNMENT. */
+
+union Header
+{
+   struct
+   {
+      union Header *psPrev;
+      union Header *psNext;
+   } sLinks;
+
+   /* Padding that keeps what follows the header aligned. */
+   char acPad[ALIGNMENT];
+};
+
+/* A released small block, which links to the next released block of
+   its size class. */
+
+struct FreeBlock
+{
+   struct FreeBlock *psNext;
+};
+
+/* An Arena bump-allocates small blocks from the newest of its slabs,
+   reuses released small blocks by size class, and keeps large blocks
+   in a doubly linked list so that each one can be released alone. */
+
+struct Arena
+{
+   /* The list of slabs, newest first, linked through psNext. */
+   union Header *psSlabs;
+
+   /* The unused part of the newest slab. */
+   char *pcNext;
+   char *pcEnd;
+
+   /* The list of large blocks. */
+   union Header *psLarge;
+
+   /* The lists of released small blocks, one per size class. */
+   struct FreeBlock *apsFree[NUM_CLASSES];
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return uSize rounded up to a non-zero multiple of ALIGNMENT. */
+
+static size_t Arena_round(size_t uSize)
+{
+   if (uSize == 0)
+      uSize = 1;
+   return (uSize + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+Arena_T Arena_new(void)
+{
+   return (struct Arena*)calloc(1, sizeof(struct Arena));
+}
+
+/*--------------------------------------------------------------------*/
+
+void Arena_free(Arena_T oArena)
+{
+   union Header *psHeader;
+   union Header *psNext;
+
+   if (oArena == NULL)
+      return;
+
+   for (psHeader = oArena->psSlabs; psHeader != NULL; psHeader = psNext)
+   {
+      psNext = psHeader->sLinks.psNext;
+      free(psHeader);
+   }
+   for (psHeader = oArena->psLarge; psHeader != NULL; psHeader = psNext)
+   {
+      psNext = psHeader->sLinks.psNext;
+      free(psHeader);
+   }
+   free(oArena);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new block of uSize bytes, which exceeds MAX_SMALL_SIZE,
+   linked into oArena's list of large blocks, or NULL if insufficient
+   memory is available. */
+
+static void *Arena_allocLarge(Arena_T oArena, size_t uSize)
+{
+   union Header *psHeader;
+
+   assert(oArena != NULL);
+
+   psHeader = (union Header*)calloc(1, sizeof(union Header) + uSize);
+   if (psHeader == NULL)
+      return NULL;
+
+   psHeader->sLinks.psNext = oArena->psLarge;
+   if (oArena->psLarge != NULL)
+      oArena->psLarge->sLinks.psPrev = psHeader;
+   oArena->psLarge = psHeader;
+   return psHeader + 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *Arena_alloc(Arena_T oArena, size_t uSize)
+{
+   struct FreeBlock **ppsFree;
+   union Header *psSlab;
+   void *pv;
+
+   if (oArena == NULL)
+      return calloc(1, uSize);
+
+   uSize = Arena_round(uSize);
+   if (uSize > MAX_SMALL_SIZE)
+      return Arena_allocLarge(oArena, uSize);
+
+   /* Prefer a released block of the same size class. */
+   ppsFree = &oArena->apsFree[uSize / ALIGNMENT - 1];
+   if (*ppsFree != NULL)
+   {
+      pv = *ppsFree;
+      *ppsFree = (*ppsFree)->psNext;
+      memset(pv, 0, uSize);
+      return pv;
+   }
+
+   /* Start a new slab if the newest one is used up.  Whatever is
+      left of the old one is too small to be worth tracking. */
+   if ((size_t)(oArena->pcEnd - oArena->pcNext) < uSize)
+   {
+      psSlab = (union Header*)calloc(1, SLAB_SIZE);
+      if (psSlab == NULL)
+         return NULL;
+      psSlab->sLinks.psNext = oArena->psSlabs;
+      oArena->psSlabs = psSlab;
+      oArena->pcNext = (char*)(psSlab + 1);
+      oArena->pcEnd = (char*)psSlab + SLAB_SIZE;
+   }
+
+   pv = oArena->pcNext;
+   oArena->pcNext += uSize;
+   return pv;
+}
+
+/*--------------------------------------------------------------------*/
+
+void Arena_release(Arena_T oArena, void *pv, size_t uSize)
+{
+   union Header *psHeader;
+   struct FreeBlock *psFree;
+
+   if (oArena == NULL)
+   {
+      free(pv);
+      return;
+   }
+   if (pv == NULL)
+      return;
+
+   uSize = Arena_round(uSize);
+   if (uSize > MAX_SMALL_SIZE)
+   {
+      psHeader = (union Header*)pv - 1;
+      if (psHeader->sLinks.psPrev != NULL)
+         psHeader->sLinks.psPrev->sLinks.psNext =
+            psHeader->sLinks.psNext;
+      else
+         oArena->psLarge = psHeader->sLinks.psNext;
+      if (psHeader->sLinks.psNext != NULL)
+         psHeader->sLinks.psNext->sLinks.psPrev =
+            psHeader->sLinks.psPrev;
+      free(psHeader);
+      return;
+   }
+
+   psFree = (struct FreeBlock*)pv;
+   psFree->psNext = oArena->apsFree[uSize / ALIGNMENT - 1];
+   oArena->apsFree[uSize / ALIGNMENT - 1] = psFree;
+}
+
+/*--------------------------------------------------------------------*/
+
+void Arena_reset(Arena_T oArena)
+{
+   union Header *psHeader;
+   union Header *psNext;
+   union Header *psKept;
+
+   assert(oArena != NULL);
+
+   for (psHeader = oArena->psLarge; psHeader != NULL; psHeader = psNext)
+   {
+      psNext = psHeader->sLinks.psNext;
+      free(psHeader);
+   }
+   oArena->psLarge = NULL;
+   memset(oArena->apsFree, 0, sizeof(oArena->apsFree));
+
+   /* Keep the newest slab, zeroed again where it was used, so that a
+      scratch arena stops calling malloc once it has warmed up. */
+   psKept = oArena->psSlabs;
+   if (psKept == NULL)
+      return;
+   for (psHeader = psKept->sLinks.psNext; psHeader != NULL;
+        psHeader = psNext)
+   {
+      psNext = psHeader->sLinks.psNext;
+      free(psHeader);
+   }
+   psKept->sLinks.psNext = NULL;
+   memset(psKept + 1, 0, (size_t)(oArena->pcNext - (char*)(psKept + 1)));
+   oArena->pcNext = (char*)(psKept + 1);
+}
@@ -0,0 +1,57 @@
+/*--------------------------------------------------------------------*/
+/* arena.h                                                            */
+/* Author: Roy Mazumder and Roshaan Khalid                            */
+/*--------------------------------------------------------------------*/
+
+#ifndef ARENA_INCLUDED
+#define ARENA_INCLUDED
+
+#include <stddef.h>
+
+/* An Arena_T object hands out memory carved from large slabs, so that
+   an allocation is usually a pointer bump, and frees all of it at
+   once.  Released blocks are kept for reuse by later allocations of
+   the same size.  Wherever an Arena_T is accepted, NULL stands for
+   the heap, i.e., calloc and free. */
+
+typedef struct Arena *Arena_T;
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new empty Arena_T object, or NULL if insufficient memory
+   is available. */
+
+Arena_T Arena_new(void);
+
+/*--------------------------------------------------------------------*/
+
+/* Free oArena, and with it every block ever allocated from it, in
+   time proportional to the number of slabs rather than blocks. */
+
+void Arena_free(Arena_T oArena);
+
+/*--------------------------------------------------------------------*/
+
+/* Return a block of uSize zeroed bytes from oArena, suitably aligned
+   for any object, or NULL if insufficient memory is available. */
+
+void *Arena_alloc(Arena_T oArena, size_t uSize);
+
+/*--------------------------------------------------------------------*/
+
+/* Give the block pv of uSize bytes, which was allocated from oArena
+   with that same size, back to oArena.  pv may be NULL. */
+
+void Arena_release(Arena_T oArena, void *pv, size_t uSize);
+
+/*--------------------------------------------------------------------*/
+
+/* Free every block ever allocated from oArena at once, but keep
+   oArena, and one slab of its memory, for more.  oArena must not be
+   NULL.  An arena that is reset at the end of each operation serves
+   as a scratch arena for the operation's temporaries: taking one is a
+   pointer bump, and none can outlive the operation. */
+
+void Arena_reset(Arena_T oArena);
+
+#endif
@@ -0,0 +1,739 @@
+/*--------------------------------------------------------------------*/
+/* btree.c                                                            */
+/* Author: Roy Mazumder and Roshaan Khalid                            */
+/*--------------------------------------------------------------------*/
+
+#include "btree.h"
+#include <assert.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The minimum degree of a BTree: every node but the root has at least
+   DEGREE - 1 keys, and every node has at most MAX_KEYS keys. */
+
+enum {DEGREE = 8};
+enum {MAX_KEYS = 2 * DEGREE - 1};
+
+/*--------------------------------------------------------------------*/
+
+/* A node of a BTree.  The bindings of a node are in order, and every
+   key of the subtree apsChildren[u] lies between the keys u - 1 and u
+   of the node. */
+
+struct Node
+{
+   /* The number of bindings in the subtree rooted at the node, which
+      gives the rank of each binding without a walk. */
+   size_t uSize;
+
+   /* The number of bindings in the node itself. */
+   size_t uCount;
+
+   /* 1 (TRUE) iff the node is a leaf.  A leaf never becomes an inner
+      node, or vice versa. */
+   int iLeaf;
+
+   /* The first bytes of each key, packed so that they compare like
+      the keys do.  A search scans these two cache lines, and reads
+      the keys themselves only to break ties. */
+   unsigned long aulPrefixes[MAX_KEYS];
+
+   /* The keys and their values. */
+   const char *apcKeys[MAX_KEYS];
+   const void *apvValues[MAX_KEYS];
+
+   /* The children.  A leaf is allocated without this array. */
+   struct Node *apsChildren[MAX_KEYS + 1];
+};
+
+/* A BTree is a pointer to its root, which is never NULL, and the place
+   its nodes come from. */
+
+struct BTree
+{
+   /* The root node, an empty leaf if the BTree is empty. */
+   struct Node *psRoot;
+
+   /* The Arena from which the BTree and its nodes come, or NULL if
+      they come from the heap. */
+   Arena_T oArena;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bytes that a node of the given kind takes. */
+
+static size_t BTree_nodeSize(int iLeaf)
+{
+   if (iLeaf)
+      return offsetof(struct Node, apsChildren);
+   return sizeof(struct Node);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new empty node of oBTree, a leaf iff iLeaf, or NULL if
+   insufficient memory is available. */
+
+static struct Node *BTree_newNode(BTree_T oBTree, int iLeaf)
+{
+   struct Node *psNode;
+
+   psNode = (struct Node*)Arena_alloc(oBTree->oArena,
+                                      BTree_nodeSize(iLeaf));
+   if (psNode == NULL)
+      return NULL;
+   psNode->iLeaf = iLeaf;
+   return psNode;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Give psNode back to the place it came from in oBTree. */
+
+static void BTree_releaseNode(BTree_T oBTree, struct Node *psNode)
+{
+   Arena_release(oBTree->oArena, psNode, BTree_nodeSize(psNode->iLeaf));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the first bytes of the key of uLength characters at pcKey,
+   big end first and padded with zeros, so that comparing the results
+   of two keys as numbers is comparing the keys with strcmp, up to a
+   tie. */
+
+static unsigned long BTree_prefix(const char *pcKey, size_t uLength)
+{
+   unsigned long ulPrefix = 0;
+   size_t u;
+
+   assert(pcKey != NULL);
+
+   for (u = 0; u < sizeof(unsigned long); u++)
+   {
+      ulPrefix <<= 8;
+      if (u < uLength)
+         ulPrefix |= (unsigned char)pcKey[u];
+   }
+   return ulPrefix;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return <0, 0, or >0 depending upon whether the uIndex'th key of
+   psNode is less than, equal to, or greater than the key of uLength
+   characters at pcKey, whose prefix is ulPrefix. */
+
+static int BTree_compareAt(struct Node *psNode, size_t uIndex,
+                           unsigned long ulPrefix, const char *pcKey,
+                           size_t uLength)
+{
+   int iCompare;
+
+   if (psNode->aulPrefixes[uIndex] < ulPrefix)
+      return -1;
+   if (psNode->aulPrefixes[uIndex] > ulPrefix)
+      return 1;
+   /* Equal prefixes that end in a zero byte are equal keys. */
+   if ((ulPrefix & 0xff) == 0)
+      return 0;
+   /* pcKey need not end in '\0', but the keys in psNode do */
+   iCompare = strncmp(psNode->apcKeys[uIndex], pcKey, uLength);
+   if (iCompare == 0 && psNode->apcKeys[uIndex][uLength] != '\0')
+      return 1;
+   return iCompare;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the first key of psNode that is not less than
+   the key of uLength characters at pcKey, whose prefix is ulPrefix.
+   Assign 1 (TRUE) to *piFound iff that key is equal to pcKey. */
+
+static size_t BTree_find(struct Node *psNode, unsigned long ulPrefix,
+                         const char *pcKey, size_t uLength,
+                         int *piFound)
+{
+   size_t u = 0;
+   int iCompare = 1;
+
+   while (u < psNode->uCount
+          && (iCompare = BTree_compareAt(psNode, u, ulPrefix, pcKey,
+                                      uLength)) < 0)
+      u++;
+   *piFound = (u < psNode->uCount && iCompare == 0);
+   return u;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Copy uCount bindings of psSrc, from index uSrc on, over the bindings
+   of psDst from index uDst on.  The ranges may overlap. */
+
+static void BTree_moveEntries(struct Node *psDst, size_t uDst,
+                              struct Node *psSrc, size_t uSrc,
+                              size_t uCount)
+{
+   memmove(&psDst->aulPrefixes[uDst], &psSrc->aulPrefixes[uSrc],
+           uCount * sizeof(unsigned long));
+   memmove(&psDst->apcKeys[uDst], &psSrc->apcKeys[uSrc],
+           uCount * sizeof(const char*));
+   memmove(&psDst->apvValues[uDst], &psSrc->apvValues[uSrc],
+           uCount * sizeof(const void*));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Copy uCount children of psSrc, from index uSrc on, over the children
+   of psDst from index uDst on.  The ranges may overlap. */
+
+static void BTree_moveChildren(struct Node *psDst, size_t uDst,
+                               struct Node *psSrc, size_t uSrc,
+                               size_t uCount)
+{
+   memmove(&psDst->apsChildren[uDst], &psSrc->apsChildren[uSrc],
+           uCount * sizeof(struct Node*));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Split the full uIndex'th child of psParent, which is not full, into
+   two nodes around its middle binding, which moves up into psParent.
+   Return 1 (TRUE) if successful, or 0 (FALSE) if insufficient memory
+   is available, in which case nothing changes. */
+
+static int BTree_splitChild(BTree_T oBTree, struct Node *psParent,
+                            size_t uIndex)
+{
+   struct Node *psFull = psParent->apsChildren[uIndex];
+   struct Node *psNew;
+   size_t u;
+
+   assert(psFull->uCount == MAX_KEYS);
+   assert(psParent->uCount < MAX_KEYS);
+
+   psNew = BTree_newNode(oBTree, psFull->iLeaf);
+   if (psNew == NULL)
+      return 0;
+
+   /* The upper half goes to psNew. */
+   BTree_moveEntries(psNew, 0, psFull, DEGREE, DEGREE - 1);
+   psNew->uCount = DEGREE - 1;
+   psNew->uSize = DEGREE - 1;
+   if (! psFull->iLeaf)
+   {
+      BTree_moveChildren(psNew, 0, psFull, DEGREE, DEGREE);
+      for (u = 0; u < DEGREE; u++)
+         psNew->uSize += psNew->apsChildren[u]->uSize;
+   }
+   psFull->uCount = DEGREE - 1;
+   psFull->uSize -= psNew->uSize + 1;
+
+   /* The middle binding goes up, with psNew to its right. */
+   BTree_moveChildren(psParent, uIndex + 2, psParent, uIndex + 1,
+                      psParent->uCount - uIndex);
+   BTree_moveEntries(psParent, uIndex + 1, psParent, uIndex,
+                     psParent->uCount - uIndex);
+   BTree_moveEntries(psParent, uIndex, psFull, DEGREE - 1, 1);
+   psParent->apsChildren[uIndex + 1] = psNew;
+   psParent->uCount++;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the node of oBTree that holds the key of uLength characters
+   at pcKey, whose prefix is ulPrefix, and assign the key's index in it
+   to *puIndex, or return NULL if the key is not in oBTree. */
+
+static struct Node *BTree_lookup(BTree_T oBTree, unsigned long ulPrefix,
+                                 const char *pcKey, size_t uLength,
+                                 size_t *puIndex)
+{
+   struct Node *psNode = oBTree->psRoot;
+   int iFound;
+
+   for (;;)
+   {
+      *puIndex = BTree_find(psNode, ulPrefix, pcKey, uLength, &iFound);
+      if (iFound)
+         return psNode;
+      if (psNode->iLeaf)
+         return NULL;
+      psNode = psNode->apsChildren[*puIndex];
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move the binding of psParent at uIndex - 1 down to the front of its
+   uIndex'th child, and the last binding of the child to its left up
+   in its place. */
+
+static void BTree_rotateRight(struct Node *psParent, size_t uIndex)
+{
+   struct Node *psLeft = psParent->apsChildren[uIndex - 1];
+   struct Node *psChild = psParent->apsChildren[uIndex];
+   size_t uMoved = 1;
+
+   BTree_moveEntries(psChild, 1, psChild, 0, psChild->uCount);
+   BTree_moveEntries(psChild, 0, psParent, uIndex - 1, 1);
+   BTree_moveEntries(psParent, uIndex - 1, psLeft, psLeft->uCount - 1, 1);
+   if (! psChild->iLeaf)
+   {
+      BTree_moveChildren(psChild, 1, psChild, 0, psChild->uCount + 1);
+      psChild->apsChildren[0] = psLeft->apsChildren[psLeft->uCount];
+      uMoved += psChild->apsChildren[0]->uSize;
+   }
+   psLeft->uCount--;
+   psLeft->uSize -= uMoved;
+   psChild->uCount++;
+   psChild->uSize += uMoved;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move the binding of psParent at uIndex down to the end of its
+   uIndex'th child, and the first binding of the child to its right up
+   in its place. */
+
+static void BTree_rotateLeft(struct Node *psParent, size_t uIndex)
+{
+   struct Node *psChild = psParent->apsChildren[uIndex];
+   struct Node *psRight = psParent->apsChildren[uIndex + 1];
+   size_t uMoved = 1;
+
+   BTree_moveEntries(psChild, psChild->uCount, psParent, uIndex, 1);
+   BTree_moveEntries(psParent, uIndex, psRight, 0, 1);
+   BTree_moveEntries(psRight, 0, psRight, 1, psRight->uCount - 1);
+   if (! psChild->iLeaf)
+   {
+      psChild->apsChildren[psChild->uCount + 1] =
+         psRight->apsChildren[0];
+      uMoved += psRight->apsChildren[0]->uSize;
+      BTree_moveChildren(psRight, 0, psRight, 1, psRight->uCount);
+   }
+   psRight->uCount--;
+   psRight->uSize -= uMoved;
+   psChild->uCount++;
+   psChild->uSize += uMoved;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Merge the binding of psParent at uIndex and the child to its right
+   into the child to its left, and release the right child. */
+
+static void BTree_merge(BTree_T oBTree, struct Node *psParent,
+                        size_t uIndex)
+{
+   struct Node *psLeft = psParent->apsChildren[uIndex];
+   struct Node *psRight = psParent->apsChildren[uIndex + 1];
+
+   BTree_moveEntries(psLeft, psLeft->uCount, psParent, uIndex, 1);
+   BTree_moveEntries(psLeft, psLeft->uCount + 1, psRight, 0,
+                     psRight->uCount);
+   if (! psLeft->iLeaf)
+      BTree_moveChildren(psLeft, psLeft->uCount + 1, psRight, 0,
+                         psRight->uCount + 1);
+   psLeft->uCount += psRight->uCount + 1;
+   psLeft->uSize += psRight->uSize + 1;
+
+   BTree_moveEntries(psParent, uIndex, psParent, uIndex + 1,
+                     psParent->uCount - uIndex - 1);
+   BTree_moveChildren(psParent, uIndex + 1, psParent, uIndex + 2,
+                      psParent->uCount - uIndex - 1);
+   psParent->uCount--;
+
+   BTree_releaseNode(oBTree, psRight);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Remove the key of uLength characters at pcKey, whose prefix is
+   ulPrefix, from the subtree rooted at psNode.  The key must be in the
+   subtree, and psNode must have at least DEGREE keys unless it is the
+   root, so that removing never has to walk back up. */
+
+static void BTree_delete(BTree_T oBTree, struct Node *psNode,
+                         unsigned long ulPrefix, const char *pcKey,
+                         size_t uLength)
+{
+   struct Node *psChild;
+   struct Node *psEnd;
+   size_t uIndex;
+   int iFound;
+
+   for (;;)
+   {
+      psNode->uSize--;
+      uIndex = BTree_find(psNode, ulPrefix, pcKey, uLength, &iFound);
+
+      if (iFound && psNode->iLeaf)
+      {
+         BTree_moveEntries(psNode, uIndex, psNode, uIndex + 1,
+                           psNode->uCount - uIndex - 1);
+         psNode->uCount--;
+         return;
+      }
+
+      if (iFound)
+      {
+         /* Replace the key with its predecessor or successor, if a
+            child can spare one, and remove that instead. */
+         psChild = psNode->apsChildren[uIndex];
+         psEnd = psNode->apsChildren[uIndex + 1];
+         if (psChild->uCount >= DEGREE)
+         {
+            while (! psChild->iLeaf)
+               psChild = psChild->apsChildren[psChild->uCount];
+            BTree_moveEntries(psNode, uIndex, psChild,
+                              psChild->uCount - 1, 1);
+            psChild = psNode->apsChildren[uIndex];
+         }
+         else if (psEnd->uCount >= DEGREE)
+         {
+            while (! psEnd->iLeaf)
+               psEnd = psEnd->apsChildren[0];
+            BTree_moveEntries(psNode, uIndex, psEnd, 0, 1);
+            psChild = psNode->apsChildren[uIndex + 1];
+         }
+         else
+         {
+            BTree_merge(oBTree, psNode, uIndex);
+            psNode = psChild;
+            continue;
+         }
+         ulPrefix = psNode->aulPrefixes[uIndex];
+         pcKey = psNode->apcKeys[uIndex];
+         uLength = strlen(pcKey);
+         psNode = psChild;
+         continue;
+      }
+
+      assert(! psNode->iLeaf);
+
+      /* Make sure the child to go down to can lose a key. */
+      psChild = psNode->apsChildren[uIndex];
+      if (psChild->uCount == DEGREE - 1)
+      {
+         if (uIndex > 0
+             && psNode->apsChildren[uIndex - 1]->uCount >= DEGREE)
+            BTree_rotateRight(psNode, uIndex);
+         else if (uIndex < psNode->uCount
+                  && psNode->apsChildren[uIndex + 1]->uCount >= DEGREE)
+            BTree_rotateLeft(psNode, uIndex);
+         else if (uIndex < psNode->uCount)
+            BTree_merge(oBTree, psNode, uIndex);
+         else
+         {
+            BTree_merge(oBTree, psNode, uIndex - 1);
+            psChild = psNode->apsChildren[uIndex - 1];
+         }
+      }
+      psNode = psChild;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free the subtree rooted at psNode of oBTree. */
+
+static void BTree_freeNode(BTree_T oBTree, struct Node *psNode)
+{
+   size_t u;
+
+   if (! psNode->iLeaf)
+      for (u = 0; u <= psNode->uCount; u++)
+         BTree_freeNode(oBTree, psNode->apsChildren[u]);
+   BTree_releaseNode(oBTree, psNode);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply *pfApply to each binding of the subtree rooted at psNode in
+   order, as BTree_map does. */
+
+static void BTree_mapNode(struct Node *psNode,
+                          void (*pfApply)(const char *pcKey,
+                                          void *pvValue,
+                                          void *pvExtra),
+                          const void *pvExtra)
+{
+   size_t u;
+
+   for (u = 0; u < psNode->uCount; u++)
+   {
+      if (! psNode->iLeaf)
+         BTree_mapNode(psNode->apsChildren[u], pfApply, pvExtra);
+      (*pfApply)(psNode->apcKeys[u], (void*)psNode->apvValues[u],
+                 (void*)pvExtra);
+   }
+   if (! psNode->iLeaf)
+      BTree_mapNode(psNode->apsChildren[u], pfApply, pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+BTree_T BTree_new(void)
+{
+   return BTree_newIn(NULL);
+}
+
+/*--------------------------------------------------------------------*/
+
+BTree_T BTree_newIn(Arena_T oArena)
+{
+   BTree_T oBTree;
+
+   oBTree = (struct BTree*)Arena_alloc(oArena, sizeof(struct BTree));
+   if (oBTree == NULL)
+      return NULL;
+
+   oBTree->oArena = oArena;
+   oBTree->psRoot = BTree_newNode(oBTree, 1);
+   if (oBTree->psRoot == NULL)
+   {
+      Arena_release(oArena, oBTree, sizeof(struct BTree));
+      return NULL;
+   }
+
+   return oBTree;
+}
+
+/*--------------------------------------------------------------------*/
+
+void BTree_free(BTree_T oBTree)
+{
+   assert(oBTree != NULL);
+
+   BTree_freeNode(oBTree, oBTree->psRoot);
+   Arena_release(oBTree->oArena, oBTree, sizeof(struct BTree));
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t BTree_getLength(BTree_T oBTree)
+{
+   assert(oBTree != NULL);
+
+   return oBTree->psRoot->uSize;
+}
+
+/*--------------------------------------------------------------------*/
+
+int BTree_put(BTree_T oBTree, const char *pcKey, const void *pvValue)
+{
+   unsigned long ulPrefix;
+   struct Node *psNode;
+   struct Node *psRoot;
+   size_t uLength;
+   size_t uIndex;
+   int iFound;
+
+   assert(oBTree != NULL);
+   assert(pcKey != NULL);
+   assert(pvValue != NULL);
+
+   uLength = strlen(pcKey);
+   ulPrefix = BTree_prefix(pcKey, uLength);
+   psNode = BTree_lookup(oBTree, ulPrefix, pcKey, uLength, &uIndex);
+   if (psNode != NULL)
+   {
+      psNode->apcKeys[uIndex] = pcKey;
+      psNode->apvValues[uIndex] = pvValue;
+      return 1;
+   }
+
+   /* First split every full node on the way down, which keeps the
+      BTree valid if memory runs out part of the way. */
+   if (oBTree->psRoot->uCount == MAX_KEYS)
+   {
+      psRoot = BTree_newNode(oBTree, 0);
+      if (psRoot == NULL)
+         return 0;
+      psRoot->apsChildren[0] = oBTree->psRoot;
+      psRoot->uSize = oBTree->psRoot->uSize;
+      if (! BTree_splitChild(oBTree, psRoot, 0))
+      {
+         BTree_releaseNode(oBTree, psRoot);
+         return 0;
+      }
+      oBTree->psRoot = psRoot;
+   }
+   psNode = oBTree->psRoot;
+   while (! psNode->iLeaf)
+   {
+      uIndex = BTree_find(psNode, ulPrefix, pcKey, uLength, &iFound);
+      if (psNode->apsChildren[uIndex]->uCount == MAX_KEYS)
+      {
+         if (! BTree_splitChild(oBTree, psNode, uIndex))
+            return 0;
+         if (BTree_compareAt(psNode, uIndex, ulPrefix, pcKey,
+                             uLength) < 0)
+            uIndex++;
+      }
+      psNode = psNode->apsChildren[uIndex];
+   }
+
+   /* Then walk the same path, which now has room everywhere. */
+   psNode = oBTree->psRoot;
+   for (;;)
+   {
+      psNode->uSize++;
+      uIndex = BTree_find(psNode, ulPrefix, pcKey, uLength, &iFound);
+      if (psNode->iLeaf)
+         break;
+      psNode = psNode->apsChildren[uIndex];
+   }
+   BTree_moveEntries(psNode, uIndex + 1, psNode, uIndex,
+                     psNode->uCount - uIndex);
+   psNode->aulPrefixes[uIndex] = ulPrefix;
+   psNode->apcKeys[uIndex] = pcKey;
+   psNode->apvValues[uIndex] = pvValue;
+   psNode->uCount++;
+
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *BTree_get(BTree_T oBTree, const char *pcKey)
+{
+   struct Node *psNode;
+   size_t uLength;
+   size_t uIndex;
+
+   assert(oBTree != NULL);
+   assert(pcKey != NULL);
+
+   uLength = strlen(pcKey);
+   psNode = BTree_lookup(oBTree, BTree_prefix(pcKey, uLength), pcKey,
+                         uLength, &uIndex);
+   if (psNode == NULL)
+      return NULL;
+   return (void*)psNode->apvValues[uIndex];
+}
+
+/*--------------------------------------------------------------------*/
+
+int BTree_search(BTree_T oBTree, const char *pcKey, size_t *puIndex)
+{
+   assert(pcKey != NULL);
+
+   return BTree_searchChars(oBTree, pcKey, strlen(pcKey), puIndex);
+}
+
+/*--------------------------------------------------------------------*/
+
+int BTree_searchChars(BTree_T oBTree, const char *pcKey, size_t uLength,
+                      size_t *puIndex)
+{
+   unsigned long ulPrefix;
+   struct Node *psNode;
+   size_t uIndex;
+   size_t uRank = 0;
+   size_t u;
+   int iFound;
+
+   assert(oBTree != NULL);
+   assert(pcKey != NULL);
+   assert(puIndex != NULL);
+
+   ulPrefix = BTree_prefix(pcKey, uLength);
+   psNode = oBTree->psRoot;
+   for (;;)
+   {
+      uIndex = BTree_find(psNode, ulPrefix, pcKey, uLength, &iFound);
+      uRank += uIndex;
+      if (psNode->iLeaf)
+      {
+         *puIndex = uRank;
+         return iFound;
+      }
+      for (u = 0; u < uIndex; u++)
+         uRank += psNode->apsChildren[u]->uSize;
+      if (iFound)
+      {
+         *puIndex = uRank + psNode->apsChildren[uIndex]->uSize;
+         return 1;
+      }
+      psNode = psNode->apsChildren[uIndex];
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+void *BTree_getAt(BTree_T oBTree, size_t uIndex)
+{
+   struct Node *psNode;
+   size_t uSize;
+   size_t u;
+
+   assert(oBTree != NULL);
+   assert(uIndex < oBTree->psRoot->uSize);
+
+   psNode = oBTree->psRoot;
+   while (! psNode->iLeaf)
+   {
+      for (u = 0; ; u++)
+      {
+         uSize = psNode->apsChildren[u]->uSize;
+         if (uIndex < uSize)
+            break;
+         if (uIndex == uSize)
+            return (void*)psNode->apvValues[u];
+         uIndex -= uSize + 1;
+      }
+      psNode = psNode->apsChildren[u];
+   }
+   return (void*)psNode->apvValues[uIndex];
+}
+
+/*--------------------------------------------------------------------*/
+
+void *BTree_remove(BTree_T oBTree, const char *pcKey)
+{
+   unsigned long ulPrefix;
+   struct Node *psNode;
+   const void *pvOldValue;
+   size_t uLength;
+   size_t uIndex;
+
+   assert(oBTree != NULL);
+   assert(pcKey != NULL);
+
+   uLength = strlen(pcKey);
+   ulPrefix = BTree_prefix(pcKey, uLength);
+   psNode = BTree_lookup(oBTree, ulPrefix, pcKey, uLength, &uIndex);
+   if (psNode == NULL)
+      return NULL;
+   pvOldValue = psNode->apvValues[uIndex];
+
+   BTree_delete(oBTree, oBTree->psRoot, ulPrefix, pcKey, uLength);
+
+   /* An inner root left without keys gives way to its only child. */
+   psNode = oBTree->psRoot;
+   if (psNode->uCount == 0 && ! psNode->iLeaf)
+   {
+      oBTree->psRoot = psNode->apsChildren[0];
+      BTree_releaseNode(oBTree, psNode);
+   }
+
+   return (void*)pvOldValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void BTree_map(BTree_T oBTree,
+               void (*pfApply)(const char *pcKey, void *pvValue,
+                               void *pvExtra),
+               const void *pvExtra)
+{
+   assert(oBTree != NULL);
+   assert(pfApply != NULL);
+
+   BTree_mapNode(oBTree->psRoot, pfApply, pvExtra);
+}
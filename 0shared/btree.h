@@ -0,0 +1,106 @@
+/*--------------------------------------------------------------------*/
+/* btree.h                                                            */
+/* Author: Roy Mazumder and Roshaan Khalid                            */
+/*--------------------------------------------------------------------*/
+
+#ifndef BTREE_INCLUDED
+#define BTREE_INCLUDED
+
+#include <stddef.h>
+#include "arena.h"
+
+/* A BTree_T object maps string keys to values, keeping the bindings
+   in strcmp order of their keys.  Lookups, insertions and removals
+   take O(log n) time, and so does getting the binding of a given
+   rank, so a BTree can stand in for a DynArray kept sorted with
+   DynArray_bsearch and DynArray_addAt.  The keys are borrowed, not
+   copied: the memory of each key must stay unchanged for as long as
+   the key is in the BTree. */
+
+typedef struct BTree *BTree_T;
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new empty BTree_T object, or NULL if insufficient memory
+   is available. */
+
+BTree_T BTree_new(void);
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new empty BTree_T object like BTree_new, but allocated
+   with its nodes from oArena.  BTree_new() is BTree_newIn(NULL). */
+
+BTree_T BTree_newIn(Arena_T oArena);
+
+/*--------------------------------------------------------------------*/
+
+/* Free oBTree.  Keys and values are not freed. */
+
+void BTree_free(BTree_T oBTree);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bindings in oBTree. */
+
+size_t BTree_getLength(BTree_T oBTree);
+
+/*--------------------------------------------------------------------*/
+
+/* Bind pcKey to pvValue in oBTree, replacing any existing binding for
+   an equal key.  pvValue must not be NULL.  Return 1 (TRUE) if
+   successful, or 0 (FALSE) if insufficient memory is available. */
+
+int BTree_put(BTree_T oBTree, const char *pcKey, const void *pvValue);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the value bound to pcKey in oBTree, or NULL if there is no
+   such binding. */
+
+void *BTree_get(BTree_T oBTree, const char *pcKey);
+
+/*--------------------------------------------------------------------*/
+
+/* Search oBTree for pcKey.  If it is found, then assign its rank
+   (the number of smaller keys) to *puIndex and return 1.  If it is not
+   found, then assign the rank it would have to *puIndex and return 0.
+   This is the contract of DynArray_bsearch. */
+
+int BTree_search(BTree_T oBTree, const char *pcKey, size_t *puIndex);
+
+/*--------------------------------------------------------------------*/
+
+/* Search oBTree for the key of uLength characters at pcKey, which
+   need not end in '\0', like BTree_search. */
+
+int BTree_searchChars(BTree_T oBTree, const char *pcKey, size_t uLength,
+                      size_t *puIndex);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the value of the binding of rank uIndex in oBTree.  uIndex
+   must be less than the length of oBTree. */
+
+void *BTree_getAt(BTree_T oBTree, size_t uIndex);
+
+/*--------------------------------------------------------------------*/
+
+/* Remove the binding for pcKey from oBTree.  Return the value it was
+   bound to, or NULL if there was no such binding. */
+
+void *BTree_remove(BTree_T oBTree, const char *pcKey);
+
+/*--------------------------------------------------------------------*/
+
+/* Apply function *pfApply to each binding of oBTree in order, passing
+   pvExtra as an extra argument.  That is, for each binding of pcKey to
+   pvValue, smallest key first, call (*pfApply)(pcKey, pvValue,
+   pvExtra). */
+
+void BTree_map(BTree_T oBTree,
+               void (*pfApply)(const char *pcKey, void *pvValue,
+                               void *pvExtra),
+               const void *pvExtra);
+
+#endif
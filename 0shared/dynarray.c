@@ -4,8 +4,18 @@
 /*--------------------------------------------------------------------*/
 
 #include "dynarray.h"
+#include "typedarray.h"
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
+
+/* DynArray_parallelSort uses POSIX threads if this file is compiled
+   with -pthread, which defines _REENTRANT. */
+
+#ifdef _REENTRANT
+#define DYNARRAY_THREADS
+#include <pthread.h>
+#endif
 
 /*--------------------------------------------------------------------*/
 
@@ -13,6 +23,29 @@
 
 static const size_t MIN_PHYS_LENGTH = 2;
 
+/* The minimum length of a DynArray object that DynArray_bsearch
+   searches through a shadow index, if it is indexed at all. */
+
+static const size_t MIN_INDEXED_LENGTH = 1024;
+
+#ifdef DYNARRAY_THREADS
+/* The least number of elements that DynArray_parallelSort gives each
+   thread. */
+
+static const size_t MIN_PARALLEL_LENGTH = 16384;
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Prefetch the memory at address pv, which DynArray_bsearch is about
+   to read, if the compiler can. */
+
+#ifdef __GNUC__
+#define DYNARRAY_PREFETCH(pv) __builtin_prefetch(pv)
+#else
+#define DYNARRAY_PREFETCH(pv) ((void)0)
+#endif
+
 /*--------------------------------------------------------------------*/
 
 /* A DynArray consists of an array, along with its logical and
@@ -30,6 +63,21 @@ struct DynArray
 
    /* The array that underlies the DynArray. */
    const void **ppvArray;
+
+   /* The Arena from which the DynArray and its array come, or NULL
+      if they come from the heap. */
+   Arena_T oArena;
+
+   /* Whether DynArray_bsearch keeps a shadow index. */
+   int iIndexed;
+
+   /* The shadow index: a copy of the array in Eytzinger order, with
+      each entry's index in the array, or NULL if there is none or it
+      is out of date.  Its block, from oArena, holds uIndexLength+1
+      entries of each. */
+   const void **ppvIndex;
+   size_t *puIndexRanks;
+   size_t uIndexLength;
 };
 
 /*--------------------------------------------------------------------*/
@@ -51,10 +99,29 @@ static int DynArray_isValid(DynArray_T oDynArray)
 
 /*--------------------------------------------------------------------*/
 
-/* Increase the physical length of oDynArray.  Return 1 (TRUE) if
-   successful and 0 (FALSE) if insufficient memory is available. */
+/* Throw away the shadow index of oDynArray, if it has one, because
+   oDynArray is about to change. */
+
+static void DynArray_dropIndex(DynArray_T oDynArray)
+{
+   assert(oDynArray != NULL);
+
+   if (oDynArray->ppvIndex == NULL)
+      return;
+   Arena_release(oDynArray->oArena, oDynArray->ppvIndex,
+                 (oDynArray->uIndexLength + 1)
+                 * (sizeof(void*) + sizeof(size_t)));
+   oDynArray->ppvIndex = NULL;
+   oDynArray->puIndexRanks = NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Increase the physical length of oDynArray to at least
+   uMinPhysLength.  Return 1 (TRUE) if successful and 0 (FALSE) if
+   insufficient memory is available. */
 
-static int DynArray_grow(DynArray_T oDynArray)
+static int DynArray_grow(DynArray_T oDynArray, size_t uMinPhysLength)
 {
    const size_t GROWTH_FACTOR = 2;
 
@@ -63,12 +130,36 @@ static int DynArray_grow(DynArray_T oDynArray)
 
    assert(oDynArray != NULL);
 
-   uNewLength = GROWTH_FACTOR * oDynArray->uPhysLength;
-
-   ppvNewArray = (const void**)
-      realloc(oDynArray->ppvArray, sizeof(void*) * uNewLength);
-   if (ppvNewArray == NULL)
+   if (uMinPhysLength > (size_t)-1 / sizeof(void*))
       return 0;
+   uNewLength = oDynArray->uPhysLength;
+   while (uNewLength < uMinPhysLength)
+   {
+      if (uNewLength > (size_t)-1 / sizeof(void*) / GROWTH_FACTOR)
+         uNewLength = uMinPhysLength;
+      else
+         uNewLength *= GROWTH_FACTOR;
+   }
+
+   if (oDynArray->oArena == NULL)
+   {
+      ppvNewArray = (const void**)
+         realloc(oDynArray->ppvArray, sizeof(void*) * uNewLength);
+      if (ppvNewArray == NULL)
+         return 0;
+   }
+   else
+   {
+      /* An Arena cannot resize a block in place. */
+      ppvNewArray = (const void**)
+         Arena_alloc(oDynArray->oArena, sizeof(void*) * uNewLength);
+      if (ppvNewArray == NULL)
+         return 0;
+      memcpy(ppvNewArray, oDynArray->ppvArray,
+             sizeof(void*) * oDynArray->uLength);
+      Arena_release(oDynArray->oArena, oDynArray->ppvArray,
+                    sizeof(void*) * oDynArray->uPhysLength);
+   }
 
    oDynArray->uPhysLength = uNewLength;
    oDynArray->ppvArray = ppvNewArray;
@@ -78,24 +169,33 @@ static int DynArray_grow(DynArray_T oDynArray)
 /*--------------------------------------------------------------------*/
 
 DynArray_T DynArray_new(size_t uLength)
+{
+   return DynArray_newIn(NULL, uLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+DynArray_T DynArray_newIn(Arena_T oArena, size_t uLength)
 {
    DynArray_T oDynArray;
 
-   oDynArray = (struct DynArray*)malloc(sizeof(struct DynArray));
+   oDynArray = (struct DynArray*)
+      Arena_alloc(oArena, sizeof(struct DynArray));
    if (oDynArray == NULL)
       return NULL;
 
+   oDynArray->oArena = oArena;
    oDynArray->uLength = uLength;
    if (uLength > MIN_PHYS_LENGTH)
       oDynArray->uPhysLength = uLength;
    else
       oDynArray->uPhysLength = MIN_PHYS_LENGTH;
 
-   oDynArray->ppvArray =
-      (const void**)calloc(oDynArray->uPhysLength, sizeof(void*));
+   oDynArray->ppvArray = (const void**)
+      Arena_alloc(oArena, sizeof(void*) * oDynArray->uPhysLength);
    if (oDynArray->ppvArray == NULL)
    {
-      free(oDynArray);
+      Arena_release(oArena, oDynArray, sizeof(struct DynArray));
       return NULL;
    }
 
@@ -109,8 +209,11 @@ void DynArray_free(DynArray_T oDynArray)
    assert(oDynArray != NULL);
    assert(DynArray_isValid(oDynArray));
 
-   free(oDynArray->ppvArray);
-   free(oDynArray);
+   DynArray_dropIndex(oDynArray);
+
+   Arena_release(oDynArray->oArena, oDynArray->ppvArray,
+                 sizeof(void*) * oDynArray->uPhysLength);
+   Arena_release(oDynArray->oArena, oDynArray, sizeof(struct DynArray));
 }
 
 /*--------------------------------------------------------------------*/
@@ -136,6 +239,28 @@ void *DynArray_get(DynArray_T oDynArray, size_t uIndex)
 
 /*--------------------------------------------------------------------*/
 
+void **DynArray_getArray(DynArray_T oDynArray)
+{
+   assert(oDynArray != NULL);
+   assert(DynArray_isValid(oDynArray));
+
+   DynArray_dropIndex(oDynArray);
+
+   return (void**)oDynArray->ppvArray;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *const *DynArray_getElements(DynArray_T oDynArray)
+{
+   assert(oDynArray != NULL);
+   assert(DynArray_isValid(oDynArray));
+
+   return (void *const *)oDynArray->ppvArray;
+}
+
+/*--------------------------------------------------------------------*/
+
 void *DynArray_set(DynArray_T oDynArray, size_t uIndex,
                    const void *pvElement)
 {
@@ -145,6 +270,8 @@ void *DynArray_set(DynArray_T oDynArray, size_t uIndex,
    assert(uIndex < oDynArray->uLength);
    assert(DynArray_isValid(oDynArray));
 
+   DynArray_dropIndex(oDynArray);
+
    pvOldElement = oDynArray->ppvArray[uIndex];
    oDynArray->ppvArray[uIndex] = pvElement;
 
@@ -160,8 +287,10 @@ int DynArray_add(DynArray_T oDynArray, const void *pvElement)
    assert(oDynArray != NULL);
    assert(DynArray_isValid(oDynArray));
 
+   DynArray_dropIndex(oDynArray);
+
    if (oDynArray->uLength == oDynArray->uPhysLength)
-      if (! DynArray_grow(oDynArray))
+      if (! DynArray_grow(oDynArray, oDynArray->uLength + 1))
          return 0;
 
    oDynArray->ppvArray[oDynArray->uLength] = pvElement;
@@ -177,18 +306,19 @@ int DynArray_add(DynArray_T oDynArray, const void *pvElement)
 int DynArray_addAt(DynArray_T oDynArray, size_t uIndex,
                    const void *pvElement)
 {
-   size_t u;
-
    assert(oDynArray != NULL);
    assert(uIndex <= oDynArray->uLength);
    assert(DynArray_isValid(oDynArray));
 
+   DynArray_dropIndex(oDynArray);
+
    if (oDynArray->uLength == oDynArray->uPhysLength)
-      if (! DynArray_grow(oDynArray))
+      if (! DynArray_grow(oDynArray, oDynArray->uLength + 1))
          return 0;
 
-   for (u = oDynArray->uLength; u > uIndex; u--)
-      oDynArray->ppvArray[u] = oDynArray->ppvArray[u-1];
+   memmove(&oDynArray->ppvArray[uIndex + 1],
+           &oDynArray->ppvArray[uIndex],
+           sizeof(void*) * (oDynArray->uLength - uIndex));
 
    oDynArray->ppvArray[uIndex] = pvElement;
    oDynArray->uLength++;
@@ -203,18 +333,20 @@ int DynArray_addAt(DynArray_T oDynArray, size_t uIndex,
 void *DynArray_removeAt(DynArray_T oDynArray, size_t uIndex)
 {
    const void *pvOldElement;
-   size_t u;
 
    assert(oDynArray != NULL);
    assert(uIndex < oDynArray->uLength);
    assert(DynArray_isValid(oDynArray));
 
+   DynArray_dropIndex(oDynArray);
+
    pvOldElement = oDynArray->ppvArray[uIndex];
 
    oDynArray->uLength--;
 
-   for (u = uIndex; u < oDynArray->uLength; u++)
-      oDynArray->ppvArray[u] = oDynArray->ppvArray[u+1];
+   memmove(&oDynArray->ppvArray[uIndex],
+           &oDynArray->ppvArray[uIndex + 1],
+           sizeof(void*) * (oDynArray->uLength - uIndex));
 
    assert(DynArray_isValid(oDynArray));
 
@@ -223,16 +355,127 @@ void *DynArray_removeAt(DynArray_T oDynArray, size_t uIndex)
 
 /*--------------------------------------------------------------------*/
 
-void DynArray_toArray(DynArray_T oDynArray, void **ppvArray)
+int DynArray_addRangeAt(DynArray_T oDynArray, size_t uIndex,
+                        void **ppvArray, size_t uCount)
 {
-   size_t u;
+   assert(oDynArray != NULL);
+   assert(uIndex <= oDynArray->uLength);
+   assert(ppvArray != NULL || uCount == 0);
+   assert(DynArray_isValid(oDynArray));
+
+   if (uCount == 0)
+      return 1;
+   DynArray_dropIndex(oDynArray);
+   if (uCount > (size_t)-1 - oDynArray->uLength)
+      return 0;
+   if (oDynArray->uLength + uCount > oDynArray->uPhysLength)
+      if (! DynArray_grow(oDynArray, oDynArray->uLength + uCount))
+         return 0;
+
+   memmove(&oDynArray->ppvArray[uIndex + uCount],
+           &oDynArray->ppvArray[uIndex],
+           sizeof(void*) * (oDynArray->uLength - uIndex));
+   memcpy(&oDynArray->ppvArray[uIndex], ppvArray,
+          sizeof(void*) * uCount);
+   oDynArray->uLength += uCount;
+
+   assert(DynArray_isValid(oDynArray));
+
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+int DynArray_appendArray(DynArray_T oDynArray, void **ppvArray,
+                         size_t uCount)
+{
+   assert(oDynArray != NULL);
+
+   return DynArray_addRangeAt(oDynArray, oDynArray->uLength,
+                              ppvArray, uCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+void DynArray_removeRange(DynArray_T oDynArray, size_t uIndex,
+                          size_t uCount, void **ppvRemoved)
+{
+   assert(oDynArray != NULL);
+   assert(uIndex <= oDynArray->uLength);
+   assert(uCount <= oDynArray->uLength - uIndex);
+   assert(DynArray_isValid(oDynArray));
+
+   DynArray_dropIndex(oDynArray);
+
+   if (ppvRemoved != NULL)
+      memcpy(ppvRemoved, &oDynArray->ppvArray[uIndex],
+             sizeof(void*) * uCount);
+
+   oDynArray->uLength -= uCount;
+   memmove(&oDynArray->ppvArray[uIndex],
+           &oDynArray->ppvArray[uIndex + uCount],
+           sizeof(void*) * (oDynArray->uLength - uIndex));
+
+   assert(DynArray_isValid(oDynArray));
+}
+
+/*--------------------------------------------------------------------*/
+
+int DynArray_mergeSorted(DynArray_T oDynArray, void **ppvArray,
+                         size_t uCount,
+                         int (*pfCompare)(const void *pvElement1,
+                                          const void *pvElement2))
+{
+   const void **ppvOld;
+   const void **ppvNew;
+   const void **ppvDest;
 
+   assert(oDynArray != NULL);
+   assert(ppvArray != NULL || uCount == 0);
+   assert(pfCompare != NULL);
+   assert(DynArray_isValid(oDynArray));
+
+   if (uCount == 0)
+      return 1;
+   DynArray_dropIndex(oDynArray);
+   if (uCount > (size_t)-1 - oDynArray->uLength)
+      return 0;
+   if (oDynArray->uLength + uCount > oDynArray->uPhysLength)
+      if (! DynArray_grow(oDynArray, oDynArray->uLength + uCount))
+         return 0;
+
+   /* Merge from the back, so that each old element moves once and
+      straight to its place.  The pointers stay one past the elements
+      they stand for, to avoid complications with going below the
+      start of either array. */
+   ppvOld = &oDynArray->ppvArray[oDynArray->uLength];
+   ppvNew = (const void**)&ppvArray[uCount];
+   ppvDest = ppvOld + uCount;
+   while (ppvNew > (const void**)ppvArray)
+   {
+      if (ppvOld > oDynArray->ppvArray &&
+          (*pfCompare)(ppvOld[-1], ppvNew[-1]) > 0)
+         *--ppvDest = *--ppvOld;
+      else
+         *--ppvDest = *--ppvNew;
+   }
+   oDynArray->uLength += uCount;
+
+   assert(DynArray_isValid(oDynArray));
+
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void DynArray_toArray(DynArray_T oDynArray, void **ppvArray)
+{
    assert(oDynArray != NULL);
    assert(ppvArray != NULL);
    assert(DynArray_isValid(oDynArray));
 
-   for (u = 0; u < oDynArray->uLength; u++)
-      ppvArray[u] = (void*)oDynArray->ppvArray[u];
+   memcpy(ppvArray, oDynArray->ppvArray,
+          sizeof(void*) * oDynArray->uLength);
 }
 
 /*--------------------------------------------------------------------*/
@@ -253,79 +496,268 @@ void DynArray_map(DynArray_T oDynArray,
 
 /*--------------------------------------------------------------------*/
 
-/* Sort the array of elements that resides in memory at
-   addresses ppvLo...ppvHi in ascending order, as determined
-   by *pfCompare.
-   *pfCompare must return <0, 0, or >0 depending upon whether
-   *pvElement1 is less than, equal to, or greater than *pvElement2,
-   respectively. */
+/* A function that determines the order of elements, as
+   DynArray_sort describes. */
 
-static void DynArray_qsort(
-   const void **ppvLo,
-   const void **ppvHi,
-   int (*pfCompare) (const void *pvElement1, const void *pvElement2))
+typedef int (*DynArray_Compare)(const void *pvElement1,
+                                const void *pvElement2);
+
+/*--------------------------------------------------------------------*/
+
+/* Return what *pfCompare returns for pvElement1 and pvElement2, for
+   the sort that typedarray.h generates. */
+
+static int DynArray_compareWith(DynArray_Compare pfCompare,
+                                void *pvElement1, void *pvElement2)
 {
-   /* This function implements a variation of the quicksort algorithm
-      shown in the book "Algorithms + Data Structures = Programs" by
-      Niklaus Wirth. */
+   return (*pfCompare)(pvElement1, pvElement2);
+}
 
-   /* This function uses pointers instead of indices to avoid
-      complications with using unsigned integers as array indices. */
+/*--------------------------------------------------------------------*/
 
-   const void **ppvRight;
-   const void **ppvLeft;
-   const void *pvPivot;
-   const void *pvTemp;
+/* Sort the elements at addresses ppvLo...ppvHi-1 in ascending order,
+   as determined by *pfCompare, in O(n log n) time for any order they
+   start out in:
+      void DynArray_sortElements(void **ppvLo, void **ppvHi,
+                                 DynArray_Compare pfCompare); */
 
-   assert(ppvLo != NULL);
-   assert(ppvHi != NULL);
+DYNARRAY_DEFINE_SORT_WITH(DynArray, DynArray_Compare,
+                          DynArray_compareWith)
+
+/*--------------------------------------------------------------------*/
+
+void DynArray_sort(DynArray_T oDynArray,
+                   int (*pfCompare)(const void *pvElement1,
+                                    const void *pvElement2))
+{
+   assert(oDynArray != NULL);
+
+   DynArray_sortRange(oDynArray, 0, oDynArray->uLength, pfCompare);
+}
+
+/*--------------------------------------------------------------------*/
+
+void DynArray_sortRange(DynArray_T oDynArray, size_t uIndex,
+                        size_t uCount,
+                        int (*pfCompare)(const void *pvElement1,
+                                         const void *pvElement2))
+{
+   assert(oDynArray != NULL);
+   assert(uIndex <= oDynArray->uLength);
+   assert(uCount <= oDynArray->uLength - uIndex);
    assert(pfCompare != NULL);
+   assert(DynArray_isValid(oDynArray));
+
+   if (uCount < 2)
+      return;
+
+   DynArray_dropIndex(oDynArray);
+
+   DynArray_sortElements(
+      (void**)&oDynArray->ppvArray[uIndex],
+      (void**)&oDynArray->ppvArray[uIndex + uCount],
+      pfCompare);
+
+   assert(DynArray_isValid(oDynArray));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A part of the work of DynArray_parallelSort, which one thread
+   does. */
+
+struct sortTask
+{
+   /* If ppvDest is NULL, the elements at addresses ppvLo...ppvHi-1
+      are to be sorted.  Otherwise the sorted runs at ppvLo...ppvMid-1
+      and ppvMid...ppvHi-1 are to be merged into ppvDest onward. */
+   const void **ppvLo;
+   const void **ppvMid;
+   const void **ppvHi;
+   const void **ppvDest;
 
-   ppvRight = ppvLo;
-   ppvLeft = ppvHi;
-   pvPivot = *(ppvLo + ((ppvHi - ppvLo) / 2));
+   /* The function that determines the order of the elements. */
+   DynArray_Compare pfCompare;
 
-   while (ppvRight <= ppvLeft)
+#ifdef DYNARRAY_THREADS
+   /* The thread doing the task, if iStarted is 1 (TRUE). */
+   pthread_t tThread;
+   int iStarted;
+#endif
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Do the task that pvTask, a struct sortTask, describes.  Return
+   NULL. */
+
+static void *DynArray_doTask(void *pvTask)
+{
+   struct sortTask *psTask;
+   const void **ppvLeft;
+   const void **ppvRight;
+   const void **ppvDest;
+
+   psTask = (struct sortTask*)pvTask;
+   if (psTask->ppvDest == NULL)
    {
-      while ((*pfCompare)(*ppvRight, pvPivot) < 0)
-         ppvRight++;
-      while ((*pfCompare)(pvPivot, *ppvLeft) < 0)
-         ppvLeft--;
-      if (ppvRight <= ppvLeft)
-      {
-         /* Swap *ppvRight and *ppvLeft. */
-         pvTemp = *ppvRight;
-         *ppvRight = *ppvLeft;
-         *ppvLeft = pvTemp;
+      DynArray_sortElements((void**)psTask->ppvLo,
+                            (void**)psTask->ppvHi, psTask->pfCompare);
+      return NULL;
+   }
 
-         ppvRight++;
-         ppvLeft--;
-      }
+   ppvLeft = psTask->ppvLo;
+   ppvRight = psTask->ppvMid;
+   ppvDest = psTask->ppvDest;
+   while (ppvLeft < psTask->ppvMid && ppvRight < psTask->ppvHi)
+   {
+      if ((*psTask->pfCompare)(*ppvRight, *ppvLeft) < 0)
+         *ppvDest++ = *ppvRight++;
+      else
+         *ppvDest++ = *ppvLeft++;
+   }
+   memcpy(ppvDest, ppvLeft,
+          (size_t)(psTask->ppvMid - ppvLeft) * sizeof(void*));
+   ppvDest += psTask->ppvMid - ppvLeft;
+   memcpy(ppvDest, ppvRight,
+          (size_t)(psTask->ppvHi - ppvRight) * sizeof(void*));
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Do the uCount tasks in psTasks at once, each in a thread of its
+   own, and wait for them to finish.  Do in the calling thread the
+   first task, and any task for which no thread can be started. */
+
+static void DynArray_doTasks(struct sortTask *psTasks, size_t uCount)
+{
+   size_t u;
+
+#ifdef DYNARRAY_THREADS
+   for (u = 1; u < uCount; u++)
+      psTasks[u].iStarted =
+         pthread_create(&psTasks[u].tThread, NULL, DynArray_doTask,
+                        &psTasks[u]) == 0;
+   DynArray_doTask(&psTasks[0]);
+   for (u = 1; u < uCount; u++)
+   {
+      if (psTasks[u].iStarted)
+         pthread_join(psTasks[u].tThread, NULL);
+      else
+         DynArray_doTask(&psTasks[u]);
    }
+#else
+   for (u = 0; u < uCount; u++)
+      DynArray_doTask(&psTasks[u]);
+#endif
+}
+
+/*--------------------------------------------------------------------*/
 
-   if (ppvLo < ppvLeft)
-      DynArray_qsort(ppvLo, ppvLeft, pfCompare);
-   if (ppvRight < ppvHi)
-      DynArray_qsort(ppvRight, ppvHi, pfCompare);
+/* Return the index of the first of the elements of the uPart'th of
+   uParts parts, of nearly equal lengths, into which uLength elements
+   are split.  The uParts'th part starts at index uLength. */
+
+static size_t DynArray_partStart(size_t uLength, size_t uParts,
+                                 size_t uPart)
+{
+   if (uPart > uParts)
+      uPart = uParts;
+   return uPart * (uLength / uParts) +
+      (uPart < uLength % uParts ? uPart : uLength % uParts);
 }
 
 /*--------------------------------------------------------------------*/
 
-void DynArray_sort(DynArray_T oDynArray,
-                   int (*pfCompare)(const void *pvElement1,
-                                    const void *pvElement2))
+void DynArray_parallelSort(DynArray_T oDynArray, size_t uThreads,
+                           int (*pfCompare)(const void *pvElement1,
+                                            const void *pvElement2))
 {
+   struct sortTask *psTasks;
+   const void **ppvBuffer;
+   const void **ppvSource;
+   const void **ppvDest;
+   const void **ppvTemp;
+   size_t uLength;
+   size_t uTasks;
+   size_t uWidth;
+   size_t u;
+
    assert(oDynArray != NULL);
    assert(pfCompare != NULL);
    assert(DynArray_isValid(oDynArray));
 
-   if (oDynArray->uLength < 2)
+   uLength = oDynArray->uLength;
+#ifdef DYNARRAY_THREADS
+   if (uThreads > uLength / MIN_PARALLEL_LENGTH)
+      uThreads = uLength / MIN_PARALLEL_LENGTH;
+#else
+   uThreads = 1;
+#endif
+
+   if (uThreads < 2)
+   {
+      DynArray_sort(oDynArray, pfCompare);
       return;
+   }
 
-   DynArray_qsort(
-      &oDynArray->ppvArray[0],
-      &oDynArray->ppvArray[oDynArray->uLength-1],
-      pfCompare);
+   psTasks = (struct sortTask*)
+      malloc(uThreads * sizeof(struct sortTask));
+   ppvBuffer = (const void**)malloc(uLength * sizeof(void*));
+   if (psTasks == NULL || ppvBuffer == NULL)
+   {
+      free(psTasks);
+      free(ppvBuffer);
+      DynArray_sort(oDynArray, pfCompare);
+      return;
+   }
+
+   DynArray_dropIndex(oDynArray);
+
+   /* Sort uThreads parts of the array at once. */
+   for (u = 0; u < uThreads; u++)
+   {
+      psTasks[u].ppvLo = oDynArray->ppvArray +
+         DynArray_partStart(uLength, uThreads, u);
+      psTasks[u].ppvHi = oDynArray->ppvArray +
+         DynArray_partStart(uLength, uThreads, u + 1);
+      psTasks[u].ppvDest = NULL;
+      psTasks[u].pfCompare = pfCompare;
+   }
+   DynArray_doTasks(psTasks, uThreads);
+
+   /* Merge neighbouring pairs of sorted runs of uWidth parts at once,
+      back and forth between the array and the buffer, until there is
+      one run left. */
+   ppvSource = oDynArray->ppvArray;
+   ppvDest = ppvBuffer;
+   for (uWidth = 1; uWidth < uThreads; uWidth *= 2)
+   {
+      uTasks = 0;
+      for (u = 0; u < uThreads; u += 2 * uWidth)
+      {
+         psTasks[uTasks].ppvLo = ppvSource +
+            DynArray_partStart(uLength, uThreads, u);
+         psTasks[uTasks].ppvMid = ppvSource +
+            DynArray_partStart(uLength, uThreads, u + uWidth);
+         psTasks[uTasks].ppvHi = ppvSource +
+            DynArray_partStart(uLength, uThreads, u + 2 * uWidth);
+         psTasks[uTasks].ppvDest = ppvDest +
+            DynArray_partStart(uLength, uThreads, u);
+         uTasks++;
+      }
+      DynArray_doTasks(psTasks, uTasks);
+
+      ppvTemp = ppvSource;
+      ppvSource = ppvDest;
+      ppvDest = ppvTemp;
+   }
+   if (ppvSource != oDynArray->ppvArray)
+      memcpy(oDynArray->ppvArray, ppvSource, uLength * sizeof(void*));
+
+   free(psTasks);
+   free(ppvBuffer);
 
    assert(DynArray_isValid(oDynArray));
 }
@@ -358,45 +790,188 @@ int DynArray_search(DynArray_T oDynArray,
 
 /*--------------------------------------------------------------------*/
 
-/* Binary search the array of elements that resides in memory at
-   addresses ppvLo...ppvHi for pvSoughtElement.
+/* Binary search the uLength elements that reside in memory from
+   address ppvLo on for pvSoughtElement, as DynArray_bsearch does.
+   uLength must be at least 1.
    *pfCompare must return <0, 0, or >0 depending upon whether
    *pvElement1 is less than, equal to, or greater than *pvElement2,
-   respectively. If pvSoughtElement is not found, *pppvInsert is set to
-   point at the memory location where it would be placed if inserted.
-*/
+   respectively. */
 
-static const void **DynArray_bsearchHelp(
+static int DynArray_bsearchHelp(
    void *pvSoughtElement,
    const void **ppvLo,
-   const void **ppvHi,
+   size_t uLength,
    int (*pfCompare)(const void *pvElement1, const void *pvElement2),
-   const void*** pppvInsert)
+   size_t *puIndex)
 {
-   /* This function uses pointers instead of indices to avoid
-      complications with using unsigned integers as array indices. */
-
-   const void **ppvMid;
+   /* This function narrows down the elements to the last one that is
+      not greater than pvSoughtElement (or the first one, if there is
+      none) without branching on the outcome of a comparison: the
+      choice of half becomes a conditional move.  As either half may be
+      next, the elements at the midpoints of both are prefetched, and
+      so are the addresses of the four midpoints after those. */
+
+   const void **ppvBase;
+   size_t uHalf;
    int iCompare;
 
    assert(ppvLo != NULL);
-   assert(ppvHi != NULL);
+   assert(uLength > 0);
    assert(pfCompare != NULL);
-   assert(pppvInsert != NULL);
+   assert(puIndex != NULL);
 
-   while (ppvLo <= ppvHi)
+   ppvBase = ppvLo;
+   while (uLength > 1)
    {
-      ppvMid = ppvLo + ((ppvHi - ppvLo) / 2);
-      iCompare = (*pfCompare)(*ppvMid, pvSoughtElement);
-      if (iCompare > 0)
-         ppvHi = ppvMid - 1;
-      else if (iCompare < 0)
-         ppvLo = ppvMid + 1;
-      else
-         return ppvMid;
+      uHalf = uLength / 2;
+      DYNARRAY_PREFETCH(ppvBase[uHalf / 2]);
+      DYNARRAY_PREFETCH(ppvBase[uHalf + uHalf / 2]);
+      DYNARRAY_PREFETCH(ppvBase + uHalf / 4);
+      DYNARRAY_PREFETCH(ppvBase + uHalf / 2 + uHalf / 4);
+      DYNARRAY_PREFETCH(ppvBase + uHalf + uHalf / 4);
+      DYNARRAY_PREFETCH(ppvBase + uHalf + uHalf / 2 + uHalf / 4);
+      ppvBase = ((*pfCompare)(ppvBase[uHalf], pvSoughtElement) <= 0) ?
+         ppvBase + uHalf : ppvBase;
+      uLength -= uHalf;
    }
-   *pppvInsert = ppvLo;
-   return NULL;
+
+   /* Only the first element can be greater, and then pvSoughtElement
+      belongs before it; otherwise it belongs after a lesser one. */
+   iCompare = (*pfCompare)(*ppvBase, pvSoughtElement);
+   *puIndex = (size_t)(ppvBase - ppvLo) + (iCompare < 0);
+   return iCompare == 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Fill the entries of oDynArray's shadow index from the uK'th on, in
+   Eytzinger order, with its elements from the uNext'th on.  Return
+   the index of the first element not used. */
+
+static size_t DynArray_fillIndex(DynArray_T oDynArray, size_t uK,
+                                 size_t uNext)
+{
+   assert(oDynArray != NULL);
+
+   if (uK > oDynArray->uLength)
+      return uNext;
+
+   /* Entry uK's left subtree holds the elements before it, and its
+      right subtree the elements after it. */
+   uNext = DynArray_fillIndex(oDynArray, 2 * uK, uNext);
+   oDynArray->ppvIndex[uK] = oDynArray->ppvArray[uNext];
+   oDynArray->puIndexRanks[uK] = uNext;
+   uNext++;
+   return DynArray_fillIndex(oDynArray, 2 * uK + 1, uNext);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Build the shadow index of oDynArray if it is not up to date.
+   Return 1 (TRUE) if successful, or 0 (FALSE) if insufficient memory
+   is available. */
+
+static int DynArray_buildIndex(DynArray_T oDynArray)
+{
+   size_t uEntries;
+
+   assert(oDynArray != NULL);
+
+   if (oDynArray->ppvIndex != NULL)
+      return 1;
+
+   /* The index is 1-based, so that entry uK's children are entries
+      2uK and 2uK+1; each entry's rank follows the entries. */
+   uEntries = oDynArray->uLength + 1;
+   oDynArray->ppvIndex = (const void**)
+      Arena_alloc(oDynArray->oArena,
+                  uEntries * (sizeof(void*) + sizeof(size_t)));
+   if (oDynArray->ppvIndex == NULL)
+      return 0;
+   oDynArray->puIndexRanks = (size_t*)(oDynArray->ppvIndex + uEntries);
+   oDynArray->uIndexLength = oDynArray->uLength;
+   (void)DynArray_fillIndex(oDynArray, 1, 0);
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Binary search oDynArray's shadow index, which must be up to date,
+   for pvSoughtElement, as DynArray_bsearch does. */
+
+static int DynArray_bsearchIndex(
+   DynArray_T oDynArray,
+   void *pvSoughtElement,
+   int (*pfCompare)(const void *pvElement1, const void *pvElement2),
+   size_t *puIndex)
+{
+   const void **ppvIndex;
+   size_t uLength;
+   size_t uK;
+
+   assert(oDynArray != NULL);
+   assert(oDynArray->ppvIndex != NULL);
+   assert(pfCompare != NULL);
+   assert(puIndex != NULL);
+
+   ppvIndex = oDynArray->ppvIndex;
+   uLength = oDynArray->uLength;
+
+   /* Descend from the root, going right past elements less than
+      pvSoughtElement.  The 16 descendants of an entry four levels
+      down are contiguous, so their addresses are prefetched together,
+      and so are the elements of its four grandchildren. */
+   uK = 1;
+   while (uK <= uLength)
+   {
+      if (16 * uK <= uLength)
+         DYNARRAY_PREFETCH(ppvIndex + 16 * uK);
+      if (4 * uK + 3 <= uLength)
+      {
+         DYNARRAY_PREFETCH(ppvIndex[4 * uK]);
+         DYNARRAY_PREFETCH(ppvIndex[4 * uK + 1]);
+         DYNARRAY_PREFETCH(ppvIndex[4 * uK + 2]);
+         DYNARRAY_PREFETCH(ppvIndex[4 * uK + 3]);
+      }
+      uK = 2 * uK + ((*pfCompare)(ppvIndex[uK], pvSoughtElement) < 0);
+   }
+
+   /* The last left turn was at the first element not less than
+      pvSoughtElement; strip the right turns after it, and it. */
+   while (uK & 1)
+      uK >>= 1;
+   uK >>= 1;
+
+   if (uK == 0)
+   {
+      *puIndex = uLength;
+      return 0;
+   }
+   *puIndex = oDynArray->puIndexRanks[uK];
+   return (*pfCompare)(ppvIndex[uK], pvSoughtElement) == 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+void DynArray_setIndexed(DynArray_T oDynArray, int iIndexed)
+{
+   assert(oDynArray != NULL);
+   assert(DynArray_isValid(oDynArray));
+
+   oDynArray->iIndexed = iIndexed;
+   if (! iIndexed)
+      DynArray_dropIndex(oDynArray);
+}
+
+/*--------------------------------------------------------------------*/
+
+int DynArray_isIndexed(DynArray_T oDynArray)
+{
+   assert(oDynArray != NULL);
+   assert(DynArray_isValid(oDynArray));
+
+   return oDynArray->iIndexed &&
+      oDynArray->uLength >= MIN_INDEXED_LENGTH;
 }
 
 /*--------------------------------------------------------------------*/
@@ -407,9 +982,6 @@ int DynArray_bsearch(DynArray_T oDynArray,
                      int (*pfCompare)(const void *pvElement1,
                                       const void *pvElement2))
 {
-   const void **ppvElement;
-   const void **ppvInsert = NULL;
-
    assert(oDynArray != NULL);
    assert(puIndex != NULL);
    assert(pfCompare != NULL);
@@ -420,18 +992,15 @@ int DynArray_bsearch(DynArray_T oDynArray,
       return 0;
    }
 
-   ppvElement = DynArray_bsearchHelp(
-      pvSoughtElement,
-      &oDynArray->ppvArray[0],
-      &oDynArray->ppvArray[oDynArray->uLength-1],
-      pfCompare,
-      &ppvInsert);
-
-   if (ppvElement == NULL) {
-      *puIndex = (size_t)(ppvInsert - &oDynArray->ppvArray[0]);
-      return 0;
-   }
-
-   *puIndex = (size_t)(ppvElement - &oDynArray->ppvArray[0]);
-   return 1;
+   if (oDynArray->iIndexed &&
+       oDynArray->uLength >= MIN_INDEXED_LENGTH &&
+       DynArray_buildIndex(oDynArray))
+      return DynArray_bsearchIndex(oDynArray, pvSoughtElement,
+                                   pfCompare, puIndex);
+
+   return DynArray_bsearchHelp(pvSoughtElement,
+                               &oDynArray->ppvArray[0],
+                               oDynArray->uLength,
+                               pfCompare,
+                               puIndex);
 }
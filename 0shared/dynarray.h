@@ -7,6 +7,7 @@
 #define DYNARRAY_INCLUDED
 
 #include <stddef.h>
+#include "arena.h"
 
 /* A DynArray_T object is an array whose length can expand
    dynamically. */
@@ -22,6 +23,15 @@ DynArray_T DynArray_new(size_t uLength);
 
 /*--------------------------------------------------------------------*/
 
+/* Return a new DynArray_T object whose length is uLength, allocated
+   with its array from oArena, or NULL if insufficient memory is
+   available.  DynArray_new(uLength) is DynArray_newIn(NULL,
+   uLength). */
+
+DynArray_T DynArray_newIn(Arena_T oArena, size_t uLength);
+
+/*--------------------------------------------------------------------*/
+
 /* Free oDynArray. */
 
 void DynArray_free(DynArray_T oDynArray);
@@ -40,6 +50,25 @@ void *DynArray_get(DynArray_T oDynArray, size_t uIndex);
 
 /*--------------------------------------------------------------------*/
 
+/* Return the array that underlies oDynArray, whose first
+   DynArray_getLength(oDynArray) elements are those of oDynArray.  The
+   array may move whenever oDynArray grows, so it is only good until
+   the next function call that adds an element.  As elements may be
+   changed through it, it throws away oDynArray's shadow index (see
+   DynArray_setIndexed). */
+
+void **DynArray_getArray(DynArray_T oDynArray);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the array that underlies oDynArray, as DynArray_getArray
+   does, but for reading only, so that oDynArray keeps its shadow
+   index. */
+
+void *const *DynArray_getElements(DynArray_T oDynArray);
+
+/*--------------------------------------------------------------------*/
+
 /* Assign pvElement to the uIndex'th element of oDynArray.  Return the
    old element. */
 
@@ -71,6 +100,50 @@ void *DynArray_removeAt(DynArray_T oDynArray, size_t uIndex);
 
 /*--------------------------------------------------------------------*/
 
+/* Add the uCount elements of ppvArray to oDynArray such that they are
+   its uIndex'th element onward, in the same order, moving the
+   elements after them only once.  Return 1 (TRUE) if successful, or
+   0 (FALSE) if insufficient memory is available. */
+
+int DynArray_addRangeAt(DynArray_T oDynArray, size_t uIndex,
+                        void **ppvArray, size_t uCount);
+
+/*--------------------------------------------------------------------*/
+
+/* Add the uCount elements of ppvArray to the end of oDynArray, in the
+   same order.  Return 1 (TRUE) if successful, or 0 (FALSE) if
+   insufficient memory is available. */
+
+int DynArray_appendArray(DynArray_T oDynArray, void **ppvArray,
+                         size_t uCount);
+
+/*--------------------------------------------------------------------*/
+
+/* Remove the uCount elements of oDynArray from its uIndex'th element
+   onward, moving the elements after them only once.  If ppvRemoved is
+   not NULL, fill it with the removed elements; it must then point to
+   an area of memory that is large enough to hold them. */
+
+void DynArray_removeRange(DynArray_T oDynArray, size_t uIndex,
+                          size_t uCount, void **ppvRemoved);
+
+/*--------------------------------------------------------------------*/
+
+/* Merge the uCount elements of ppvArray into oDynArray in one pass,
+   so that each element of oDynArray moves at most once.  Both must be
+   sorted in the order determined by *pfCompare, as DynArray_sort
+   describes, and oDynArray then is too; an element of ppvArray goes
+   after any equal element of oDynArray.  Return 1 (TRUE) if
+   successful, or 0 (FALSE), leaving oDynArray unchanged, if
+   insufficient memory is available. */
+
+int DynArray_mergeSorted(DynArray_T oDynArray, void **ppvArray,
+                         size_t uCount,
+                         int (*pfCompare)(const void *pvElement1,
+                                          const void *pvElement2));
+
+/*--------------------------------------------------------------------*/
+
 /* Fill ppvArray with the elements of oDynArray.  ppvArray must point
    to an area of memory that is large enough to hold all elements of
    oDynArray. */
@@ -92,7 +165,9 @@ void DynArray_map(DynArray_T oDynArray,
 /* Sort oDynArray in the order determined by *pfCompare.
    *pfCompare must return <0, 0, or >0 depending upon whether
    *pvElement1 is less than, equal to, or greater than *pvElement2,
-   respectively. */
+   respectively.  The sort takes O(n log n) time whatever order
+   oDynArray starts out in, and does not keep equal elements in
+   order. */
 
 void DynArray_sort(DynArray_T oDynArray,
                    int (*pfCompare)(const void *pvElement1,
@@ -100,6 +175,30 @@ void DynArray_sort(DynArray_T oDynArray,
 
 /*--------------------------------------------------------------------*/
 
+/* Sort oDynArray as DynArray_sort does, splitting the work among up to
+   uThreads threads: each sorts a part of oDynArray, and then pairs of
+   sorted parts are merged at once until one is left.  No thread gets
+   fewer than 16384 elements, so a shorter oDynArray is sorted in the
+   calling thread, as is any oDynArray if dynarray.c is compiled
+   without -pthread or if memory for merging is not available. */
+
+void DynArray_parallelSort(DynArray_T oDynArray, size_t uThreads,
+                           int (*pfCompare)(const void *pvElement1,
+                                            const void *pvElement2));
+
+/*--------------------------------------------------------------------*/
+
+/* Sort the uCount elements of oDynArray from its uIndex'th element
+   onward, leaving the others where they are, in the order determined
+   by *pfCompare as DynArray_sort describes. */
+
+void DynArray_sortRange(DynArray_T oDynArray, size_t uIndex,
+                        size_t uCount,
+                        int (*pfCompare)(const void *pvElement1,
+                                         const void *pvElement2));
+
+/*--------------------------------------------------------------------*/
+
 /* Linear search oDynArray for *pvSoughtElement using *pfCompare to
    determine equality.  If the element is found, then assign its
    index to *puIndex and return 1.  If the element is not found, then
@@ -120,7 +219,10 @@ int DynArray_search(DynArray_T oDynArray,
    index to *puIndex and return 1.  If the element is not found, then
    assign the index where it would belong to *puIndex and return 0.
    *pfCompare must return <0, 0, or >0 if *pvElement1 is less than,
-   equal to, or greater than *pvElement2.
+   equal to, or greater than *pvElement2.  pvElement1 is always an
+   element of oDynArray and pvElement2 is always pvSoughtElement, so
+   pvSoughtElement may be a key that *pfCompare compares elements
+   with, rather than an element.
    oDynArray must be sorted as determined by *pfCompare. */
 
 int DynArray_bsearch(DynArray_T oDynArray, 
@@ -129,4 +231,27 @@ int DynArray_bsearch(DynArray_T oDynArray,
                      int (*pfCompare)(const void *pvElement1,
                                       const void *pvElement2));
 
+/*--------------------------------------------------------------------*/
+
+/* Make DynArray_bsearch keep a shadow index of oDynArray if iIndexed
+   is 1 (TRUE), or stop keeping one if it is 0 (FALSE), the default.
+   The shadow index is a copy of a long oDynArray in Eytzinger
+   (breadth-first) order, whose top levels stay in the cache and whose
+   next levels can be prefetched, so searching it misses the cache far
+   less than binary searching oDynArray does.  Any change to oDynArray
+   throws the shadow index away, and the next DynArray_bsearch builds
+   it again, so it only pays off for a long array that is searched far
+   more often than it changes.  If memory for it is not available,
+   DynArray_bsearch searches oDynArray itself. */
+
+void DynArray_setIndexed(DynArray_T oDynArray, int iIndexed);
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if oDynArray keeps a shadow index and is long
+   enough that DynArray_bsearch searches through it, or 0 (FALSE)
+   otherwise. */
+
+int DynArray_isIndexed(DynArray_T oDynArray);
+
 #endif
@@ -0,0 +1,340 @@
+/*--------------------------------------------------------------------*/
+/* hashtable.c                                                        */
+/* Author: Roy Mazumder and Roshaan Khalid                            */
+/*--------------------------------------------------------------------*/
+
+#include "hashtable.h"
+#include <assert.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The minimum number of slots in a HashTable object.  Must be a power
+   of 2. */
+
+static const size_t MIN_SLOTS = 8;
+
+/*--------------------------------------------------------------------*/
+
+/* A slot of a HashTable.  A slot is empty iff its pcKey is NULL. */
+
+struct Slot
+{
+   /* The hash code of the key. */
+   size_t uHash;
+
+   /* The key, and its length in bytes. */
+   const char *pcKey;
+   size_t uKeyLength;
+
+   /* The value bound to the key. */
+   const void *pvValue;
+};
+
+/* A HashTable is an open addressing table that resolves collisions by
+   linear probing.  It is never more than half full, so probe
+   sequences stay short. */
+
+struct HashTable
+{
+   /* The number of bindings in the HashTable. */
+   size_t uLength;
+
+   /* The number of slots in the array, always a power of 2. */
+   size_t uSlots;
+
+   /* The array of slots. */
+   struct Slot *psSlots;
+
+   /* The Arena from which the HashTable and its slots come, or NULL
+      if they come from the heap. */
+   Arena_T oArena;
+};
+
+/*--------------------------------------------------------------------*/
+
+#ifndef NDEBUG
+
+/* Check the invariants of oHashTable.  Return 1 (TRUE) iff oHashTable
+   is in a valid state. */
+
+static int HashTable_isValid(HashTable_T oHashTable)
+{
+   if (oHashTable->uSlots < MIN_SLOTS) return 0;
+   if ((oHashTable->uSlots & (oHashTable->uSlots - 1)) != 0) return 0;
+   if (2 * oHashTable->uLength > oHashTable->uSlots) return 0;
+   if (oHashTable->psSlots == NULL) return 0;
+   return 1;
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+
+size_t HashTable_hash(const char *pcKey, size_t uKeyLength)
+{
+   /* 64-bit FNV-1a, folded into a size_t. */
+   unsigned long ulHash = 14695981039346656037UL;
+   size_t u;
+
+   assert(pcKey != NULL);
+
+   for (u = 0; u < uKeyLength; u++)
+   {
+      ulHash ^= (unsigned char)pcKey[u];
+      ulHash *= 1099511628211UL;
+   }
+   return (size_t)ulHash;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the slot of oHashTable that holds the key of uKeyLength bytes
+   at pcKey whose hash code is uHash, or the empty slot where that key
+   would be placed if it is not in oHashTable. */
+
+static struct Slot *HashTable_probe(HashTable_T oHashTable,
+                                    const char *pcKey,
+                                    size_t uKeyLength, size_t uHash)
+{
+   size_t uMask = oHashTable->uSlots - 1;
+   size_t u = uHash & uMask;
+   struct Slot *psSlot;
+
+   for (;;)
+   {
+      psSlot = &oHashTable->psSlots[u];
+      if (psSlot->pcKey == NULL)
+         return psSlot;
+      /* a key that shares its characters with the slot's matches
+         without reading them */
+      if (psSlot->uHash == uHash && psSlot->uKeyLength == uKeyLength
+          && (psSlot->pcKey == pcKey
+              || memcmp(psSlot->pcKey, pcKey, uKeyLength) == 0))
+         return psSlot;
+      u = (u + 1) & uMask;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Double the number of slots of oHashTable.  Return 1 (TRUE) if
+   successful and 0 (FALSE) if insufficient memory is available. */
+
+static int HashTable_grow(HashTable_T oHashTable)
+{
+   struct Slot *psOldSlots = oHashTable->psSlots;
+   size_t uOldSlots = oHashTable->uSlots;
+   struct Slot *psSlot;
+   size_t u;
+
+   assert(oHashTable != NULL);
+
+   psSlot = (struct Slot*)
+      Arena_alloc(oHashTable->oArena, 2 * uOldSlots * sizeof(struct Slot));
+   if (psSlot == NULL)
+      return 0;
+
+   oHashTable->psSlots = psSlot;
+   oHashTable->uSlots = 2 * uOldSlots;
+   for (u = 0; u < uOldSlots; u++)
+      if (psOldSlots[u].pcKey != NULL)
+      {
+         psSlot = HashTable_probe(oHashTable, psOldSlots[u].pcKey,
+                                  psOldSlots[u].uKeyLength,
+                                  psOldSlots[u].uHash);
+         *psSlot = psOldSlots[u];
+      }
+
+   Arena_release(oHashTable->oArena, psOldSlots,
+                 uOldSlots * sizeof(struct Slot));
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+HashTable_T HashTable_new(size_t uHint)
+{
+   return HashTable_newIn(NULL, uHint);
+}
+
+/*--------------------------------------------------------------------*/
+
+HashTable_T HashTable_newIn(Arena_T oArena, size_t uHint)
+{
+   HashTable_T oHashTable;
+
+   oHashTable = (struct HashTable*)
+      Arena_alloc(oArena, sizeof(struct HashTable));
+   if (oHashTable == NULL)
+      return NULL;
+
+   oHashTable->oArena = oArena;
+   oHashTable->uLength = 0;
+   oHashTable->uSlots = MIN_SLOTS;
+   while (oHashTable->uSlots < 2 * uHint)
+      oHashTable->uSlots *= 2;
+
+   oHashTable->psSlots = (struct Slot*)
+      Arena_alloc(oArena, oHashTable->uSlots * sizeof(struct Slot));
+   if (oHashTable->psSlots == NULL)
+   {
+      Arena_release(oArena, oHashTable, sizeof(struct HashTable));
+      return NULL;
+   }
+
+   return oHashTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+void HashTable_free(HashTable_T oHashTable)
+{
+   assert(oHashTable != NULL);
+   assert(HashTable_isValid(oHashTable));
+
+   Arena_release(oHashTable->oArena, oHashTable->psSlots,
+                 oHashTable->uSlots * sizeof(struct Slot));
+   Arena_release(oHashTable->oArena, oHashTable,
+                 sizeof(struct HashTable));
+}
+
+/*--------------------------------------------------------------------*/
+
+size_t HashTable_getLength(HashTable_T oHashTable)
+{
+   assert(oHashTable != NULL);
+   assert(HashTable_isValid(oHashTable));
+
+   return oHashTable->uLength;
+}
+
+/*--------------------------------------------------------------------*/
+
+int HashTable_put(HashTable_T oHashTable, const char *pcKey,
+                  size_t uKeyLength, const void *pvValue)
+{
+   assert(pcKey != NULL);
+
+   return HashTable_putHashed(oHashTable, pcKey, uKeyLength,
+                              HashTable_hash(pcKey, uKeyLength), pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+int HashTable_putHashed(HashTable_T oHashTable, const char *pcKey,
+                        size_t uKeyLength, size_t uHash,
+                        const void *pvValue)
+{
+   struct Slot *psSlot;
+
+   assert(oHashTable != NULL);
+   assert(pcKey != NULL);
+   assert(pvValue != NULL);
+   assert(HashTable_isValid(oHashTable));
+   assert(uHash == HashTable_hash(pcKey, uKeyLength));
+
+   psSlot = HashTable_probe(oHashTable, pcKey, uKeyLength, uHash);
+   if (psSlot->pcKey == NULL)
+   {
+      if (2 * (oHashTable->uLength + 1) > oHashTable->uSlots)
+      {
+         if (! HashTable_grow(oHashTable))
+            return 0;
+         psSlot = HashTable_probe(oHashTable, pcKey, uKeyLength, uHash);
+      }
+      oHashTable->uLength++;
+   }
+
+   psSlot->uHash = uHash;
+   psSlot->pcKey = pcKey;
+   psSlot->uKeyLength = uKeyLength;
+   psSlot->pvValue = pvValue;
+
+   assert(HashTable_isValid(oHashTable));
+
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *HashTable_get(HashTable_T oHashTable, const char *pcKey,
+                    size_t uKeyLength)
+{
+   assert(pcKey != NULL);
+
+   return HashTable_getHashed(oHashTable, pcKey, uKeyLength,
+                              HashTable_hash(pcKey, uKeyLength));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *HashTable_getHashed(HashTable_T oHashTable, const char *pcKey,
+                          size_t uKeyLength, size_t uHash)
+{
+   struct Slot *psSlot;
+
+   assert(oHashTable != NULL);
+   assert(pcKey != NULL);
+   assert(HashTable_isValid(oHashTable));
+   assert(uHash == HashTable_hash(pcKey, uKeyLength));
+
+   psSlot = HashTable_probe(oHashTable, pcKey, uKeyLength, uHash);
+   if (psSlot->pcKey == NULL)
+      return NULL;
+   return (void*)psSlot->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *HashTable_remove(HashTable_T oHashTable, const char *pcKey,
+                       size_t uKeyLength)
+{
+   assert(pcKey != NULL);
+
+   return HashTable_removeHashed(oHashTable, pcKey, uKeyLength,
+                                 HashTable_hash(pcKey, uKeyLength));
+}
+
+/*--------------------------------------------------------------------*/
+
+void *HashTable_removeHashed(HashTable_T oHashTable, const char *pcKey,
+                             size_t uKeyLength, size_t uHash)
+{
+   size_t uMask;
+   size_t uHole, u, uHome;
+   const void *pvOldValue;
+
+   assert(oHashTable != NULL);
+   assert(pcKey != NULL);
+   assert(HashTable_isValid(oHashTable));
+   assert(uHash == HashTable_hash(pcKey, uKeyLength));
+
+   uMask = oHashTable->uSlots - 1;
+   uHole = (size_t)(HashTable_probe(oHashTable, pcKey, uKeyLength, uHash)
+                    - oHashTable->psSlots);
+   if (oHashTable->psSlots[uHole].pcKey == NULL)
+      return NULL;
+   pvOldValue = oHashTable->psSlots[uHole].pvValue;
+
+   /* Shift later members of the probe run back into the hole, so
+      that no lookup ever stops early at it. */
+   for (u = (uHole + 1) & uMask; oHashTable->psSlots[u].pcKey != NULL;
+        u = (u + 1) & uMask)
+   {
+      uHome = oHashTable->psSlots[u].uHash & uMask;
+      /* Move the slot at u iff its home is not cyclically within
+         (uHole, u]. */
+      if (((u - uHome) & uMask) >= ((u - uHole) & uMask))
+      {
+         oHashTable->psSlots[uHole] = oHashTable->psSlots[u];
+         uHole = u;
+      }
+   }
+   oHashTable->psSlots[uHole].pcKey = NULL;
+   oHashTable->uLength--;
+
+   assert(HashTable_isValid(oHashTable));
+
+   return (void*)pvOldValue;
+}
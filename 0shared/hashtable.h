@@ -0,0 +1,100 @@
+/*--------------------------------------------------------------------*/
+/* hashtable.h                                                        */
+/* Author: Roy Mazumder and Roshaan Khalid                            */
+/*--------------------------------------------------------------------*/
+
+#ifndef HASHTABLE_INCLUDED
+#define HASHTABLE_INCLUDED
+
+#include <stddef.h>
+#include "arena.h"
+
+/* A HashTable_T object maps string keys of known length to values.
+   The keys are borrowed, not copied: the memory of each key must stay
+   unchanged for as long as the key is in the HashTable. */
+
+typedef struct HashTable *HashTable_T;
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new empty HashTable_T object with room for about uHint
+   bindings before it has to grow, or NULL if insufficient memory is
+   available. */
+
+HashTable_T HashTable_new(size_t uHint);
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new empty HashTable_T object like HashTable_new, but
+   allocated with its slots from oArena.  HashTable_new(uHint) is
+   HashTable_newIn(NULL, uHint). */
+
+HashTable_T HashTable_newIn(Arena_T oArena, size_t uHint);
+
+/*--------------------------------------------------------------------*/
+
+/* Free oHashTable.  Keys and values are not freed. */
+
+void HashTable_free(HashTable_T oHashTable);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bindings in oHashTable. */
+
+size_t HashTable_getLength(HashTable_T oHashTable);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the hash code that oHashTable objects use for the uKeyLength
+   bytes at pcKey. */
+
+size_t HashTable_hash(const char *pcKey, size_t uKeyLength);
+
+/*--------------------------------------------------------------------*/
+
+/* Bind the uKeyLength bytes at pcKey to pvValue in oHashTable,
+   replacing any existing binding for an equal key.  pvValue must not
+   be NULL.  Return 1 (TRUE) if successful, or 0 (FALSE) if
+   insufficient memory is available. */
+
+int HashTable_put(HashTable_T oHashTable, const char *pcKey,
+                  size_t uKeyLength, const void *pvValue);
+
+/*--------------------------------------------------------------------*/
+
+/* Do what HashTable_put does, given uHash, which must be
+   HashTable_hash(pcKey, uKeyLength), so as not to hash the key again.
+   The same goes for HashTable_getHashed and HashTable_removeHashed. */
+
+int HashTable_putHashed(HashTable_T oHashTable, const char *pcKey,
+                        size_t uKeyLength, size_t uHash,
+                        const void *pvValue);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the value bound to the uKeyLength bytes at pcKey in
+   oHashTable, or NULL if there is no such binding. */
+
+void *HashTable_get(HashTable_T oHashTable, const char *pcKey,
+                    size_t uKeyLength);
+
+/*--------------------------------------------------------------------*/
+
+void *HashTable_getHashed(HashTable_T oHashTable, const char *pcKey,
+                          size_t uKeyLength, size_t uHash);
+
+/*--------------------------------------------------------------------*/
+
+/* Remove the binding for the uKeyLength bytes at pcKey from
+   oHashTable.  Return the value it was bound to, or NULL if there was
+   no such binding. */
+
+void *HashTable_remove(HashTable_T oHashTable, const char *pcKey,
+                       size_t uKeyLength);
+
+/*--------------------------------------------------------------------*/
+
+void *HashTable_removeHashed(HashTable_T oHashTable, const char *pcKey,
+                             size_t uKeyLength, size_t uHash);
+
+#endif
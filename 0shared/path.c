@@ -4,161 +4,706 @@
 /*--------------------------------------------------------------------*/
 
 #include <assert.h>
-#include <stdlib.h>
 #include <string.h>
 
-#include "dynarray.h"
+#include "hashtable.h"
 #include "path.h"
 
-/* An absolute path */
+/* Where one component of a path lies in its pathname */
+struct component {
+   /* The index of the component's first character */
+   size_t ulOffset;
+   /* The string length of the component */
+   size_t ulLength;
+   /* The component's HashTable_hash, so that matching it against a
+      name can rule out most mismatches without reading either */
+   size_t uHash;
+};
+
+/*
+  An absolute path. A path is immutable and reference counted, so a
+  copy of it is just another reference. A path made by Path_new owns
+  one block holding the struct, its component table and both strings,
+  so that it costs one allocation and one release. A proper prefix
+  in the same arena points into the block of the path that owns it,
+  and holds a reference to that path. One that Path_prefix makes also
+  has a '\0'-terminated copy of its pathname. One that Path_prefixIn
+  makes is just the struct, so that it costs O(1).
+*/
 struct path {
    /* The string representation of the path,
-      which uses '/' as the component delimiter */
+      which uses '/' as the component delimiter; in a prefix, it is
+      not '\0'-terminated */
    const char *pcPath;
    /* The string length of pcPath */
    size_t ulLength;
-   /* The ordered collection of component strings in the path */
-   DynArray_T oDComponents;
+   /* A copy of the owner's pathname with each '/' turned into '\0',
+      so that every component is a string in place */
+   const char *pcComponents;
+   /* The number of components in the path */
+   size_t ulDepth;
+   /* The ordered table of where the components lie in pcPath,
+      and so in pcComponents */
+   const struct component *psComponents;
+   /* The arena the path comes from, or NULL for the heap */
+   Arena_T oArena;
+   /* The number of references to the path */
+   size_t ulRefCount;
+   /* The path whose block this one shares, or NULL if it owns one */
+   struct path *psOwner;
+   /* For a prefix that Path_prefix made, a '\0'-terminated copy of
+      pcPath, or NULL for any other path */
+   char *pcPathname;
+};
+
+/* The number of allocations this module has made for paths, and the
+   bytes they came to, which Path_getAllocStats reports */
+static size_t ulPathAllocs;
+static size_t ulPathBytes;
+
+/*
+  Returns the number of bytes in the block of a path with ulDepth
+  components and a pathname of string length ulLength.
+*/
+static size_t Path_getBlockSize(size_t ulDepth, size_t ulLength) {
+   return sizeof(struct path) + ulDepth * sizeof(struct component)
+      + 2 * (ulLength + 1);
+}
+
+/*
+  Allocates from oArena the block of a path with ulDepth components
+  and a pathname of string length ulLength, and points its fields at
+  the parts of the block. Returns the path, whose strings and table
+  are still to be filled in, or NULL if memory could not be allocated.
+*/
+static struct path *Path_alloc(Arena_T oArena, size_t ulDepth,
+                               size_t ulLength) {
+   struct path *psNew;
+   char *pcNext;
+
+   psNew = Arena_alloc(oArena, Path_getBlockSize(ulDepth, ulLength));
+   if(psNew == NULL)
+      return NULL;
+   ulPathAllocs++;
+   ulPathBytes += Path_getBlockSize(ulDepth, ulLength);
+
+   /* the table first, as it is the part that needs alignment */
+   psNew->psComponents = (struct component *) (psNew + 1);
+   pcNext = (char *) (psNew->psComponents + ulDepth);
+   psNew->pcPath = pcNext;
+   psNew->pcComponents = pcNext + ulLength + 1;
+   psNew->ulLength = ulLength;
+   psNew->ulDepth = ulDepth;
+   psNew->oArena = oArena;
+   psNew->ulRefCount = 1;
+   psNew->psOwner = NULL;
+   psNew->pcPathname = NULL;
+   return psNew;
+}
+
+/*
+  Path_scan has a kernel for SSE2, which every x86-64 processor has,
+  and one for AVX2, picked at run time if the processor has it. Other
+  targets, and compilers without GCC's builtins, get the scalar loop.
+*/
+#if defined(__GNUC__) && defined(__SSE2__) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define PATH_SCAN_SIMD
+#include <immintrin.h>
+/* The kernels read whole aligned blocks around the string. GCC says
+   it is instrumenting with __SANITIZE_ADDRESS__, clang only through
+   __has_feature, which must be tested in an #if of its own */
+#if defined(__SANITIZE_ADDRESS__)
+#define PATH_ASAN
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define PATH_ASAN
+#endif
+#endif
+#ifdef PATH_ASAN
+#define PATH_NO_ASAN __attribute__((no_sanitize_address))
+#else
+#define PATH_NO_ASAN
+#endif
+#endif
+
+#ifdef PATH_SCAN_SIMD
+/* The state of a scan of a pathname, shared by all scan kernels */
+struct scan {
+   /* The number of components found so far */
+   size_t ulDepth;
+   /* Where to record the starts of the first ulMaxOffsets components,
+      or NULL */
+   size_t *pulOffsets;
+   size_t ulMaxOffsets;
+   /* Whether the last character scanned was a '/' */
+   int iAfterSlash;
+   /* The string length, once the scan is done */
+   size_t ulLength;
+   /* SUCCESS, or BAD_PATH once the pathname is known to be bad */
+   int iStatus;
 };
 
 /*
-  Frees pcStr. This wrapper is used to match the requirements of the
-  callback function pointer passed to DynArray_map. pvExtra is unused.
+  Records in *psScan the starts of the components that follow the
+  '/'s at the positions given by the bits of ulSlashes.
 */
-static void Path_freeString(char *pcStr, void *pvExtra) {
-   /* pcStr may be NULL, as this is a no-op to free.
-      pvExtra may be NULL, as it is unused. */
-   free(pcStr);
+static void Path_recordSlashes(struct scan *psScan,
+                               unsigned long ulSlashes, size_t ulBase) {
+   for(; ulSlashes != 0 && psScan->ulDepth < psScan->ulMaxOffsets;
+       ulSlashes &= ulSlashes - 1) {
+      psScan->pulOffsets[psScan->ulDepth] =
+         ulBase + (size_t) __builtin_ctzl(ulSlashes) + 1;
+      psScan->ulDepth++;
+   }
+   psScan->ulDepth += (size_t) __builtin_popcountl(ulSlashes);
 }
 
 /*
-  Sets *poDComponents to be an ordered collection of component strings
-  in pcPath, or NULL if an error occurs.
+  Scans one block of a pathname: ulWidth characters starting at index
+  ulBase, of which those that are '/' and '\0' are given by the bits of
+  ulSlashes and ulNuls. Returns 1 (TRUE) if the scan is over, because
+  the block holds the terminating '\0' or the pathname is bad, and
+  0 (FALSE) otherwise.
+*/
+static int Path_scanBlock(struct scan *psScan, unsigned long ulSlashes,
+                          unsigned long ulNuls, size_t ulBase,
+                          size_t ulWidth) {
+   size_t ulEnd = ulWidth;
+
+   /* ignore whatever follows the terminating '\0' */
+   if(ulNuls != 0) {
+      ulEnd = (size_t) __builtin_ctzl(ulNuls);
+      ulSlashes &= (1UL << ulEnd) - 1;
+   }
+
+   /* no component can be empty: no "//", even across blocks, and no
+      '/' just before the end */
+   if((ulSlashes & (ulSlashes >> 1)) != 0 ||
+      (psScan->iAfterSlash && (ulSlashes & 1) != 0) ||
+      (ulNuls != 0 &&
+       (ulEnd == 0 ? psScan->iAfterSlash
+                   : (int) ((ulSlashes >> (ulEnd - 1)) & 1)))) {
+      psScan->iStatus = BAD_PATH;
+      return 1;
+   }
+
+   if(psScan->pulOffsets != NULL)
+      Path_recordSlashes(psScan, ulSlashes, ulBase);
+   else
+      psScan->ulDepth += (size_t) __builtin_popcountl(ulSlashes);
+
+   if(ulNuls != 0) {
+      psScan->ulLength = ulBase + ulEnd;
+      return 1;
+   }
+   psScan->iAfterSlash = (int) ((ulSlashes >> (ulWidth - 1)) & 1);
+   return 0;
+}
+
+/*
+  Scans pcPath 16 characters at a time with SSE2. Loads are aligned,
+  so they never cross into a page that the string does not reach,
+  though they do read around the string.
+*/
+PATH_NO_ASAN static void Path_scanSSE2(struct scan *psScan,
+                                       const char *pcPath) {
+   const __m128i oSlash = _mm_set1_epi8('/');
+   const __m128i oNul = _mm_setzero_si128();
+   const char *pcBlock;
+   size_t ulMisalign, ulBase = 0;
+   __m128i oBlock;
+   unsigned long ulSlashes, ulNuls;
+
+   ulMisalign = (size_t) pcPath & 15;
+   pcBlock = pcPath - ulMisalign;
+   oBlock = _mm_load_si128((const __m128i *) pcBlock);
+   ulSlashes = (unsigned long) (unsigned)
+      _mm_movemask_epi8(_mm_cmpeq_epi8(oBlock, oSlash)) >> ulMisalign;
+   ulNuls = (unsigned long) (unsigned)
+      _mm_movemask_epi8(_mm_cmpeq_epi8(oBlock, oNul)) >> ulMisalign;
+   while(!Path_scanBlock(psScan, ulSlashes, ulNuls, ulBase,
+                         16 - (ulBase == 0 ? ulMisalign : 0))) {
+      ulBase = (size_t) (pcBlock + 16 - pcPath);
+      pcBlock += 16;
+      oBlock = _mm_load_si128((const __m128i *) pcBlock);
+      ulSlashes = (unsigned long) (unsigned)
+         _mm_movemask_epi8(_mm_cmpeq_epi8(oBlock, oSlash));
+      ulNuls = (unsigned long) (unsigned)
+         _mm_movemask_epi8(_mm_cmpeq_epi8(oBlock, oNul));
+   }
+}
+
+/* Scans pcPath 32 characters at a time with AVX2, as Path_scanSSE2
+   does with 16. */
+PATH_NO_ASAN __attribute__((target("avx2")))
+static void Path_scanAVX2(struct scan *psScan, const char *pcPath) {
+   const __m256i oSlash = _mm256_set1_epi8('/');
+   const __m256i oNul = _mm256_setzero_si256();
+   const char *pcBlock;
+   size_t ulMisalign, ulBase = 0;
+   __m256i oBlock;
+   unsigned long ulSlashes, ulNuls;
+
+   ulMisalign = (size_t) pcPath & 31;
+   pcBlock = pcPath - ulMisalign;
+   oBlock = _mm256_load_si256((const __m256i *) pcBlock);
+   ulSlashes = (unsigned long) (unsigned)
+      _mm256_movemask_epi8(_mm256_cmpeq_epi8(oBlock, oSlash))
+      >> ulMisalign;
+   ulNuls = (unsigned long) (unsigned)
+      _mm256_movemask_epi8(_mm256_cmpeq_epi8(oBlock, oNul))
+      >> ulMisalign;
+   while(!Path_scanBlock(psScan, ulSlashes, ulNuls, ulBase,
+                         32 - (ulBase == 0 ? ulMisalign : 0))) {
+      ulBase = (size_t) (pcBlock + 32 - pcPath);
+      pcBlock += 32;
+      oBlock = _mm256_load_si256((const __m256i *) pcBlock);
+      ulSlashes = (unsigned long) (unsigned)
+         _mm256_movemask_epi8(_mm256_cmpeq_epi8(oBlock, oSlash));
+      ulNuls = (unsigned long) (unsigned)
+         _mm256_movemask_epi8(_mm256_cmpeq_epi8(oBlock, oNul));
+   }
+}
+
+/* The kernel Path_scan uses: the SSE2 one, which PATH_SCAN_SIMD
+   already requires, until Path_pickScanKernel has looked for AVX2 */
+static void (*pfScanKernel)(struct scan *psScan, const char *pcPath) =
+   Path_scanSSE2;
+
+/* Picks the widest kernel the CPU supports. It runs once, before main,
+   so no thread ever races to set pfScanKernel. */
+__attribute__((constructor)) static void Path_pickScanKernel(void) {
+   __builtin_cpu_init();
+   if(__builtin_cpu_supports("avx2"))
+      pfScanKernel = Path_scanAVX2;
+}
+#else
+/*
+  Scans pcPath one character at a time, as the SIMD kernels do a block
+  at a time. Returns the same results as Path_scan.
+*/
+static int Path_scanScalar(const char *pcPath, size_t *pulDepth,
+                           size_t *pulLength, size_t *pulOffsets,
+                           size_t ulMaxOffsets) {
+   const char *pcEnd;
+
+   *pulDepth = 1;
+   for(pcEnd = pcPath; *pcEnd != '\0'; pcEnd++) {
+      if(*pcEnd == '/') {
+         /* the next component can't be empty */
+         if(pcEnd[1] == '/' || pcEnd[1] == '\0')
+            return BAD_PATH;
+         if(pulOffsets != NULL && *pulDepth < ulMaxOffsets)
+            pulOffsets[*pulDepth] = (size_t) (pcEnd - pcPath) + 1;
+         (*pulDepth)++;
+      }
+   }
+   *pulLength = (size_t) (pcEnd - pcPath);
+   return SUCCESS;
+}
+#endif
+
+/*
+  Checks that pcPath is a well-formed absolute path, and sets *pulDepth
+  to its number of components and *pulLength to its string length.
+  If pulOffsets is not NULL, also records the index where each of the
+  first ulMaxOffsets components starts in pulOffsets.
   Returns one of the following statuses:
-  * SUCCESS if no error occurrs
+  * SUCCESS if pcPath is well-formed
   * BAD_PATH if pcPath is the empty string,
              or begins or ends with a '/',
              or contains consecutive '/' delimiters
-  * MEMORY_ERROR if memory could not be allocated to complete request
 */
-static int Path_split(const char *pcPath, DynArray_T *poDComponents) {
-   const char *pcStart = pcPath;
-   const char *pcEnd = pcPath;
-   char *pcCopy;
-   DynArray_T oDSubstrings;
+static int Path_scan(const char *pcPath, size_t *pulDepth,
+                     size_t *pulLength, size_t *pulOffsets,
+                     size_t ulMaxOffsets) {
+#ifdef PATH_SCAN_SIMD
+   struct scan sScan;
+#endif
 
    assert(pcPath != NULL);
-   assert(poDComponents != NULL);
+   assert(pulDepth != NULL);
+   assert(pulLength != NULL);
 
-   /* path cannot be empty string */
-   if(*pcPath == '\0') {
-      *poDComponents = NULL;
+   /* path cannot be empty string, and no component can start with
+      a delimiter */
+   if(*pcPath == '\0' || *pcPath == '/')
       return BAD_PATH;
+   if(pulOffsets != NULL && ulMaxOffsets > 0)
+      pulOffsets[0] = 0;
+
+#ifdef PATH_SCAN_SIMD
+   sScan.ulDepth = 1;
+   sScan.pulOffsets = pulOffsets;
+   sScan.ulMaxOffsets = ulMaxOffsets;
+   sScan.iAfterSlash = 0;
+   sScan.ulLength = 0;
+   sScan.iStatus = SUCCESS;
+   (*pfScanKernel)(&sScan, pcPath);
+   *pulDepth = sScan.ulDepth;
+   *pulLength = sScan.ulLength;
+   return sScan.iStatus;
+#else
+   return Path_scanScalar(pcPath, pulDepth, pulLength, pulOffsets,
+                          ulMaxOffsets);
+#endif
+}
+
+int Path_new(const char *pcPath, Path_T *poPResult) {
+   return Path_newIn(NULL, pcPath, poPResult);
+}
+
+/*
+  Parses pcPath into a new path of its own in oArena, as Path_newIn
+  does without the cache.
+*/
+static int Path_parse(Arena_T oArena, const char *pcPath,
+                      Path_T *poPResult) {
+   struct path *psNew;
+   struct component *psComponent;
+   char *pcComponents;
+   size_t aulOffsets[PATH_VIEW_INLINE_DEPTH];
+   size_t ulDepth, ulLength, ulIndex;
+   const char *pcSlash;
+   int iScanResult;
+
+   assert(pcPath != NULL);
+   assert(poPResult != NULL);
+
+   iScanResult = Path_scan(pcPath, &ulDepth, &ulLength, aulOffsets,
+                           PATH_VIEW_INLINE_DEPTH);
+   if(iScanResult != SUCCESS) {
+      *poPResult = NULL;
+      return iScanResult;
    }
 
-   oDSubstrings = DynArray_new(0);
-   if(oDSubstrings == NULL) {
-      *poDComponents = NULL;
+   psNew = Path_alloc(oArena, ulDepth, ulLength);
+   if(psNew == NULL) {
+      *poPResult = NULL;
       return MEMORY_ERROR;
    }
+   memcpy((char *) psNew->pcPath, pcPath, ulLength + 1);
+   pcComponents = (char *) psNew->pcComponents;
+   memcpy(pcComponents, pcPath, ulLength + 1);
 
-   /* validate and split pcPath */
-   while(*pcEnd != '\0') {
-      pcEnd = pcStart;
-      /* component can't start with delimiter */
-      if(*pcEnd == '/') {
-         DynArray_map(oDSubstrings,
-                      (void (*)(void*, void*)) Path_freeString, NULL);
-         DynArray_free(oDSubstrings);
-         *poDComponents = NULL;
-         return BAD_PATH;
+   /* record each component, from the scan's offsets as far as they
+      go, and then by finding the rest of the delimiters */
+   psComponent = (struct component *) psNew->psComponents;
+   for(ulIndex = 0; ulIndex < ulDepth; ulIndex++) {
+      if(ulIndex < PATH_VIEW_INLINE_DEPTH)
+         psComponent[ulIndex].ulOffset = aulOffsets[ulIndex];
+      else {
+         pcSlash = strchr(pcPath + psComponent[ulIndex - 1].ulOffset,
+                          '/');
+         psComponent[ulIndex].ulOffset = (size_t) (pcSlash - pcPath) + 1;
       }
-
-      /* advance pcEnd to end of next token */
-      while(*pcEnd != '/' && *pcEnd != '\0')
-         pcEnd++;
-
-      /* final component can't end with slash */
-      if(*pcEnd == '\0' && *(pcEnd-1) == '/') {
-         DynArray_map(oDSubstrings,
-                      (void (*)(void*, void*)) Path_freeString, NULL);
-         DynArray_free(oDSubstrings);
-         *poDComponents = NULL;
-         return BAD_PATH;
+      /* terminate the previous component */
+      if(ulIndex > 0) {
+         pcComponents[psComponent[ulIndex].ulOffset - 1] = '\0';
+         psComponent[ulIndex - 1].ulLength =
+            psComponent[ulIndex].ulOffset - 1
+            - psComponent[ulIndex - 1].ulOffset;
       }
+   }
+   psComponent[ulDepth - 1].ulLength =
+      ulLength - psComponent[ulDepth - 1].ulOffset;
+   for(ulIndex = 0; ulIndex < ulDepth; ulIndex++)
+      psComponent[ulIndex].uHash =
+         HashTable_hash(pcPath + psComponent[ulIndex].ulOffset,
+                        psComponent[ulIndex].ulLength);
 
-      pcCopy = calloc((size_t)(pcEnd-pcStart+1), sizeof(char));
-      if(pcCopy == NULL) {
-         DynArray_map(oDSubstrings,
-                      (void (*)(void*, void*)) Path_freeString, NULL);
-         DynArray_free(oDSubstrings);
-         *poDComponents = NULL;
-         return MEMORY_ERROR;
-      }
+   *poPResult = psNew;
+   return SUCCESS;
+}
 
-      if( DynArray_add(oDSubstrings, pcCopy) == 0) {
-         DynArray_map(oDSubstrings,
-                      (void (*)(void*, void*)) Path_freeString, NULL);
-         DynArray_free(oDSubstrings);
-         *poDComponents = NULL;
-         return MEMORY_ERROR;
-      }
+/*
+  The parsed-path cache maps the pathnames that Path_new parsed most
+  recently to their paths, so that parsing one of them again is a
+  hash probe and a reference. It is an AO with 7 state variables.
+  Its entries are kept in a list from the most to the least recently
+  used, and once all of them are in use the least recently used one
+  makes room for the next pathname.
+*/
 
-      while(pcStart != pcEnd) {
-         *pcCopy = *pcStart;
-         pcCopy++;
-         pcStart++;
-      }
+/* An entry of the parsed-path cache */
+struct cacheEntry {
+   /* The cached path, of which the cache holds a reference; its
+      pathname is the entry's key */
+   struct path *psPath;
+   /* The pathname's HashTable_hash */
+   size_t uHash;
+   /* The entries used just more and just less recently */
+   struct cacheEntry *psNewer;
+   struct cacheEntry *psOlder;
+};
 
-      pcStart++;
+/* 1. the table of ulCacheCapacity entries, or NULL if there is no
+      cache */
+static struct cacheEntry *psCacheEntries;
+/* 2. the number of entries in psCacheEntries */
+static size_t ulCacheCapacity;
+/* 3. the number of entries ever used since the cache was set up */
+static size_t ulCacheUsed;
+/* 4. the map from pathnames to their entries */
+static HashTable_T oHCache;
+/* 5. the most and least recently used entries, or NULL */
+static struct cacheEntry *psCacheNewest;
+static struct cacheEntry *psCacheOldest;
+/* 6. the number of Path_new calls the cache answered */
+static size_t ulCacheHits;
+/* 7. the number of Path_new calls it could not answer */
+static size_t ulCacheMisses;
+
+/* Takes psEntry out of the cache's list. */
+static void Path_unlinkEntry(struct cacheEntry *psEntry) {
+   assert(psEntry != NULL);
+
+   if(psEntry->psNewer == NULL)
+      psCacheNewest = psEntry->psOlder;
+   else
+      psEntry->psNewer->psOlder = psEntry->psOlder;
+   if(psEntry->psOlder == NULL)
+      psCacheOldest = psEntry->psNewer;
+   else
+      psEntry->psOlder->psNewer = psEntry->psNewer;
+}
+
+/* Puts psEntry at the front of the cache's list, as the newest. */
+static void Path_pushEntry(struct cacheEntry *psEntry) {
+   assert(psEntry != NULL);
+
+   psEntry->psNewer = NULL;
+   psEntry->psOlder = psCacheNewest;
+   if(psCacheNewest == NULL)
+      psCacheOldest = psEntry;
+   else
+      psCacheNewest->psNewer = psEntry;
+   psCacheNewest = psEntry;
+}
+
+/*
+  Adds psPath, whose pathname's HashTable_hash is uHash, to the cache
+  as its newest entry, making room by dropping the oldest entry if
+  need be. The cache is only ever a shortcut, so if memory could not
+  be allocated for the entry, psPath is simply not cached.
+*/
+static void Path_cacheAdd(struct path *psPath, size_t uHash) {
+   struct cacheEntry *psEntry;
+
+   assert(psPath != NULL);
+
+   if(ulCacheUsed < ulCacheCapacity)
+      psEntry = &psCacheEntries[ulCacheUsed];
+   else
+      psEntry = psCacheOldest;
+   if(!HashTable_putHashed(oHCache, psPath->pcPath, psPath->ulLength,
+                           uHash, psEntry))
+      return;
+
+   if(ulCacheUsed < ulCacheCapacity)
+      ulCacheUsed++;
+   else {
+      (void) HashTable_removeHashed(oHCache, psEntry->psPath->pcPath,
+                                    psEntry->psPath->ulLength,
+                                    psEntry->uHash);
+      Path_unlinkEntry(psEntry);
+      Path_free(psEntry->psPath);
    }
+   psPath->ulRefCount++;
+   psEntry->psPath = psPath;
+   psEntry->uHash = uHash;
+   Path_pushEntry(psEntry);
+}
 
-   *poDComponents = oDSubstrings;
-   return SUCCESS;
+/*
+  Does what Path_new does, answering from the cache if pcPath is in
+  it, and otherwise adding the new path to the cache.
+*/
+static int Path_newCached(const char *pcPath, Path_T *poPResult) {
+   struct cacheEntry *psEntry;
+   size_t ulLength;
+   size_t uHash;
+   int iStatus;
+
+   ulLength = strlen(pcPath);
+   uHash = HashTable_hash(pcPath, ulLength);
+   psEntry = HashTable_getHashed(oHCache, pcPath, ulLength, uHash);
+   if(psEntry != NULL) {
+      ulCacheHits++;
+      if(psEntry != psCacheNewest) {
+         Path_unlinkEntry(psEntry);
+         Path_pushEntry(psEntry);
+      }
+      return Path_dup(psEntry->psPath, poPResult);
+   }
+
+   ulCacheMisses++;
+   iStatus = Path_parse(NULL, pcPath, poPResult);
+   if(iStatus == SUCCESS)
+      Path_cacheAdd((struct path *) *poPResult, uHash);
+   return iStatus;
 }
 
+int Path_newIn(Arena_T oArena, const char *pcPath, Path_T *poPResult) {
+   assert(pcPath != NULL);
+   assert(poPResult != NULL);
 
-int Path_new(const char *pcPath, Path_T *poPResult) {
+   /* only heap paths are cached, as they outlive any arena */
+   if(oArena == NULL && ulCacheCapacity > 0)
+      return Path_newCached(pcPath, poPResult);
+   return Path_parse(oArena, pcPath, poPResult);
+}
+
+int Path_build(Arena_T oArena, size_t ulDepth, size_t ulLength,
+               void (*pfGetPrev)(void *pvState, const char **ppcName,
+                                 size_t *pulNameLength),
+               void *pvState, Path_T *poPResult) {
    struct path *psNew;
-   int iSplitResult;
+   struct component *psComponent;
+   char *pcPath;
+   char *pcComponents;
+   const char *pcName;
+   size_t ulNameLength;
+   size_t ulOffset = ulLength;
 
-   assert(pcPath != NULL);
+   assert(ulDepth > 0);
+   assert(pfGetPrev != NULL);
    assert(poPResult != NULL);
 
-   psNew = calloc(1, sizeof(struct path));
+   psNew = Path_alloc(oArena, ulDepth, ulLength);
    if(psNew == NULL) {
       *poPResult = NULL;
       return MEMORY_ERROR;
    }
+   pcPath = (char *) psNew->pcPath;
+   pcComponents = (char *) psNew->pcComponents;
 
-   /* instantiate and fill list of components */
-   iSplitResult = Path_split(pcPath, &psNew->oDComponents);
-   if(iSplitResult != SUCCESS) {
-      Path_free(psNew);
-      *poPResult = NULL;
-      return iSplitResult;
+   /* fill both strings in from the end, where Arena_alloc has already
+      terminated them */
+   psComponent = (struct component *) psNew->psComponents + ulDepth;
+   while(psComponent != psNew->psComponents) {
+      psComponent--;
+      (*pfGetPrev)(pvState, &pcName, &ulNameLength);
+      assert(ulNameLength > 0 && ulNameLength <= ulOffset);
+      assert(memchr(pcName, '/', ulNameLength) == NULL);
+      ulOffset -= ulNameLength;
+      memcpy(pcPath + ulOffset, pcName, ulNameLength);
+      memcpy(pcComponents + ulOffset, pcName, ulNameLength);
+      psComponent->ulOffset = ulOffset;
+      psComponent->ulLength = ulNameLength;
+      psComponent->uHash = HashTable_hash(pcName, ulNameLength);
+      if(psComponent != psNew->psComponents) {
+         assert(ulOffset > 0);
+         pcPath[--ulOffset] = '/';
+      }
+   }
+   assert(ulOffset == 0);
+
+   *poPResult = psNew;
+   return SUCCESS;
+}
+
+int Path_setCacheCapacity(size_t ulCapacity) {
+   struct cacheEntry *psEntries = NULL;
+   HashTable_T oHTable = NULL;
+   struct cacheEntry *psEntry;
+
+   if(ulCapacity > 0) {
+      if(ulCapacity > (size_t) -1 / sizeof(struct cacheEntry))
+         return MEMORY_ERROR;
+      psEntries = Arena_alloc(NULL,
+                              ulCapacity * sizeof(struct cacheEntry));
+      if(psEntries == NULL)
+         return MEMORY_ERROR;
+      oHTable = HashTable_new(ulCapacity);
+      if(oHTable == NULL) {
+         Arena_release(NULL, psEntries,
+                       ulCapacity * sizeof(struct cacheEntry));
+         return MEMORY_ERROR;
+      }
    }
 
-   psNew->ulLength = strlen(pcPath);
-   psNew->pcPath = malloc(psNew->ulLength+1);
-   if(psNew->pcPath == NULL) {
-      Path_free(psNew);
+   /* drop the old cache's references before forgetting it */
+   for(psEntry = psCacheNewest; psEntry != NULL;
+       psEntry = psEntry->psOlder)
+      Path_free(psEntry->psPath);
+   if(oHCache != NULL)
+      HashTable_free(oHCache);
+   if(psCacheEntries != NULL)
+      Arena_release(NULL, psCacheEntries,
+                    ulCacheCapacity * sizeof(struct cacheEntry));
+
+   psCacheEntries = psEntries;
+   ulCacheCapacity = ulCapacity;
+   ulCacheUsed = 0;
+   oHCache = oHTable;
+   psCacheNewest = NULL;
+   psCacheOldest = NULL;
+   ulCacheHits = 0;
+   ulCacheMisses = 0;
+   return SUCCESS;
+}
+
+void Path_getCacheStats(size_t *pulHits, size_t *pulMisses) {
+   assert(pulHits != NULL);
+   assert(pulMisses != NULL);
+
+   *pulHits = ulCacheHits;
+   *pulMisses = ulCacheMisses;
+}
+
+void Path_getAllocStats(size_t *pulAllocs, size_t *pulBytes) {
+   assert(pulAllocs != NULL);
+   assert(pulBytes != NULL);
+
+   *pulAllocs = ulPathAllocs;
+   *pulBytes = ulPathBytes;
+}
+
+/*
+  Creates the prefix of oPPath with depth ulDepth, which is at most
+  oPPath's, as a path of its own in oArena, copying its pathname and
+  its part of the component table. Returns SUCCESS or MEMORY_ERROR.
+*/
+static int Path_copyPrefix(Arena_T oArena, Path_T oPPath, size_t ulDepth,
+                           Path_T *poPResult) {
+   struct path *psNew;
+   const struct component *psLast;
+   size_t ulLength;
+
+   /* the prefix's pathname ends where its last component does */
+   psLast = &oPPath->psComponents[ulDepth - 1];
+   ulLength = psLast->ulOffset + psLast->ulLength;
+
+   psNew = Path_alloc(oArena, ulDepth, ulLength);
+   if(psNew == NULL) {
       *poPResult = NULL;
       return MEMORY_ERROR;
    }
-   strcpy((char *)psNew->pcPath, pcPath);
+   memcpy((char *) psNew->pcPath, oPPath->pcPath, ulLength);
+   memcpy((char *) psNew->pcComponents, oPPath->pcComponents, ulLength);
+   memcpy((struct component *) psNew->psComponents,
+          oPPath->psComponents, ulDepth * sizeof(struct component));
+   /* Arena_alloc zeroes the block, so both strings are terminated */
 
    *poPResult = psNew;
    return SUCCESS;
 }
 
-int Path_prefix(Path_T oPPath, size_t ulDepth, Path_T *poPResult) {
+/*
+  Creates the prefix of oPPath with depth ulDepth in oArena, as
+  Path_prefixIn does. If it shares oPPath's memory and iTerminate is 1
+  (TRUE), it also gets a '\0'-terminated copy of its pathname, as
+  Path_prefix describes. Returns the statuses that Path_prefix does.
+*/
+static int Path_makePrefix(Arena_T oArena, Path_T oPPath, size_t ulDepth,
+                           int iTerminate, Path_T *poPResult) {
    struct path *psNew;
-   size_t ulIndex, ulLength, ulSum;
-   const char *pcComponent;
-   char *pcCopy;
-   char *pcBuild;
-   char *pcInsert;
+   struct path *psOwner;
+   const struct component *psLast;
+   char *pcPathname = NULL;
+   size_t ulLength;
 
    assert(oPPath != NULL);
    assert(poPResult != NULL);
@@ -175,89 +720,118 @@ int Path_prefix(Path_T oPPath, size_t ulDepth, Path_T *poPResult) {
       return NO_SUCH_PATH;
    }
 
-   psNew = calloc(1, sizeof(struct path));
-   if(psNew == NULL) {
-      *poPResult = NULL;
-      return MEMORY_ERROR;
-   }
+   /* only a path in the same arena may share oPPath's memory */
+   if(oArena != oPPath->oArena)
+      return Path_copyPrefix(oArena, oPPath, ulDepth, poPResult);
 
-   psNew->oDComponents = DynArray_new(ulDepth);
-   if(psNew->oDComponents == NULL) {
-      Path_free(psNew);
-      *poPResult = NULL;
-      return MEMORY_ERROR;
-   }
+   /* oPPath is its own prefix, unless it needs a string of its own
+      and has none */
+   if(ulDepth == Path_getDepth(oPPath) &&
+      (!iTerminate || oPPath->psOwner == NULL ||
+       oPPath->pcPathname != NULL))
+      return Path_dup(oPPath, poPResult);
+
+   /* share the block of whichever path owns oPPath's */
+   psOwner = oPPath->psOwner;
+   if(psOwner == NULL)
+      psOwner = (struct path *) oPPath;
+
+   /* the prefix's pathname ends where its last component does */
+   psLast = &psOwner->psComponents[ulDepth - 1];
+   ulLength = psLast->ulOffset + psLast->ulLength;
 
-   pcBuild = calloc(Path_getStrLength(oPPath)+1, sizeof(char));
-   if(pcBuild == NULL) {
-      Path_free(psNew);
+   psNew = Arena_alloc(oArena, sizeof(struct path));
+   if(psNew == NULL) {
       *poPResult = NULL;
       return MEMORY_ERROR;
    }
-
-   pcInsert = pcBuild;
-   ulSum = 0;
-
-   for(ulIndex = 0; ulIndex < ulDepth; ulIndex++) {
-      /* deep copy each component to new DynArray */
-      pcComponent = Path_getComponent(oPPath, ulIndex);
-      ulLength = strlen(pcComponent);
-      pcCopy = calloc(ulLength + 1, sizeof(char));
-      if(pcCopy == NULL) {
-         free(pcBuild);
-         Path_free(psNew);
+   ulPathAllocs++;
+   ulPathBytes += sizeof(struct path);
+   /* the pathname runs on into the owner's, so it is terminated in a
+      copy of its own */
+   if(iTerminate) {
+      pcPathname = Arena_alloc(oArena, ulLength + 1);
+      if(pcPathname == NULL) {
+         Arena_release(oArena, psNew, sizeof(struct path));
          *poPResult = NULL;
          return MEMORY_ERROR;
       }
-      strcpy(pcCopy, pcComponent);
-      (void) DynArray_set(psNew->oDComponents, ulIndex, pcCopy);
-      /* construct prefix's pathname string */
-      strcpy(pcInsert, pcComponent);
-      pcInsert[ulLength] = '/';
-      ulSum += ulLength + 1;
-      pcInsert += ulLength + 1;
-   }
-   pcBuild[ulSum-1] = '\0';
-
-   /* shrink allocation to fit prefix's pathname string if needed */
-   pcInsert = realloc(pcBuild, ulSum);
-   if(pcInsert == NULL) {
-      free(pcBuild);
-      Path_free(psNew);
-      *poPResult = NULL;
-      return MEMORY_ERROR;
+      ulPathAllocs++;
+      ulPathBytes += ulLength + 1;
+      memcpy(pcPathname, psOwner->pcPath, ulLength);
+      /* Arena_alloc zeroes the copy, so it is terminated */
    }
-   psNew->ulLength = ulSum-1;
-   psNew->pcPath = pcInsert;
+   psNew->pcPath = psOwner->pcPath;
+   psNew->ulLength = ulLength;
+   psNew->pcComponents = psOwner->pcComponents;
+   psNew->ulDepth = ulDepth;
+   psNew->psComponents = psOwner->psComponents;
+   psNew->oArena = oArena;
+   psNew->ulRefCount = 1;
+   psNew->psOwner = psOwner;
+   psNew->pcPathname = pcPathname;
+   psOwner->ulRefCount++;
 
    *poPResult = psNew;
    return SUCCESS;
 }
 
+int Path_prefix(Path_T oPPath, size_t ulDepth, Path_T *poPResult) {
+   assert(oPPath != NULL);
+   assert(poPResult != NULL);
+
+   return Path_makePrefix(oPPath->oArena, oPPath, ulDepth, 1, poPResult);
+}
+
+int Path_prefixIn(Arena_T oArena, Path_T oPPath, size_t ulDepth,
+                  Path_T *poPResult) {
+   assert(oPPath != NULL);
+   assert(poPResult != NULL);
+
+   return Path_makePrefix(oArena, oPPath, ulDepth, 0, poPResult);
+}
+
 int Path_dup(Path_T oPPath, Path_T *poPResult) {
    assert(oPPath != NULL);
    assert(poPResult != NULL);
 
-   return Path_prefix(oPPath, Path_getDepth(oPPath), poPResult);
+   ((struct path *) oPPath)->ulRefCount++;
+   *poPResult = oPPath;
+   return SUCCESS;
 }
 
 void Path_free(Path_T oPPath) {
-   if(oPPath != NULL) {
-      free((char *)oPPath->pcPath);
+   struct path *psPath = (struct path *) oPPath;
 
-      if(oPPath->oDComponents != NULL) {
-         DynArray_map(oPPath->oDComponents,
-                      (void (*)(void*, void*)) Path_freeString, NULL);
-         DynArray_free(oPPath->oDComponents);
-      }
+   if(psPath == NULL)
+      return;
+
+   assert(psPath->ulRefCount > 0);
+   psPath->ulRefCount--;
+   if(psPath->ulRefCount > 0)
+      return;
+
+   if(psPath->psOwner == NULL) {
+      Arena_release(psPath->oArena, psPath,
+                    Path_getBlockSize(psPath->ulDepth,
+                                      psPath->ulLength));
+      return;
    }
-   free((struct path*) oPPath);
+   if(psPath->pcPathname != NULL)
+      Arena_release(psPath->oArena, psPath->pcPathname,
+                    psPath->ulLength + 1);
+   Path_free(psPath->psOwner);
+   Arena_release(psPath->oArena, psPath, sizeof(struct path));
 }
 
 const char *Path_getPathname(Path_T oPPath) {
    assert(oPPath != NULL);
+   /* a prefix that Path_prefixIn shares has no string of its own */
+   assert(oPPath->psOwner == NULL || oPPath->pcPathname != NULL);
 
-   return oPPath->pcPath;
+   if(oPPath->psOwner == NULL)
+      return oPPath->pcPath;
+   return oPPath->pcPathname;
 }
 
 size_t Path_getStrLength(Path_T oPPath) {
@@ -266,41 +840,453 @@ size_t Path_getStrLength(Path_T oPPath) {
    return oPPath->ulLength;
 }
 
+const char *Path_getChars(Path_T oPPath) {
+   assert(oPPath != NULL);
+
+   return oPPath->pcPath;
+}
+
+/*
+  Compares the ulLength1 bytes at pc1 with the ulLength2 bytes at pc2
+  as strcmp would compare them as strings.
+*/
+static int Path_compareBytes(const char *pc1, size_t ulLength1,
+                             const char *pc2, size_t ulLength2) {
+   int iResult;
+
+   iResult = memcmp(pc1, pc2,
+                    ulLength1 < ulLength2 ? ulLength1 : ulLength2);
+   if(iResult != 0)
+      return iResult;
+   if(ulLength1 == ulLength2)
+      return 0;
+   return ulLength1 < ulLength2 ? -1 : 1;
+}
+
 int Path_comparePath(Path_T oPPath1, Path_T oPPath2) {
    assert(oPPath1 != NULL);
    assert(oPPath2 != NULL);
 
-   return strcmp(oPPath1->pcPath, oPPath2->pcPath);
+   return Path_compareBytes(oPPath1->pcPath, oPPath1->ulLength,
+                            oPPath2->pcPath, oPPath2->ulLength);
 }
 
 int Path_compareString(Path_T oPPath, const char *pcStr) {
    assert(oPPath != NULL);
    assert(pcStr != NULL);
 
-   return strcmp(oPPath->pcPath, pcStr);
+   return Path_compareBytes(oPPath->pcPath, oPPath->ulLength,
+                            pcStr, strlen(pcStr));
+}
+
+/* Buckets of fewer keys than this are sorted by Path_multikeySort
+   instead of by another radix pass */
+static const size_t RADIX_MIN_COUNT = 64;
+/* Runs of fewer keys than this are sorted by insertion */
+static const size_t MULTIKEY_MIN_COUNT = 8;
+/* The number of characters of its pathname that a sort key caches */
+static const size_t CACHED_CHARS = sizeof(size_t);
+/* How many keys ahead of the one being read a sort prefetches */
+static const size_t PREFETCH_DISTANCE = 8;
+
+#ifdef __GNUC__
+#define PATH_PREFETCH(pv) __builtin_prefetch(pv)
+#else
+#define PATH_PREFETCH(pv) ((void) 0)
+#endif
+
+/* A pathname being sorted, with the array element it came from */
+struct sortKey {
+   /* CACHED_CHARS characters of the pathname, from the depth that the
+      sort has got to, packed into a number first character first, so
+      that comparing numbers compares the characters. A character past
+      the end of the pathname counts as 0: pathnames hold no '\0', so
+      a pathname still comes before those it is a proper prefix of, as
+      Path_comparePath has it. */
+   size_t uCache;
+   /* The characters of the pathname, not necessarily terminated */
+   const char *pcChars;
+   size_t ulLength;
+   void *pvElement;
+};
+
+/*
+  Fills psKey's cache with the characters of its pathname from
+  ulDepth onward.
+*/
+static void Path_fillCache(struct sortKey *psKey, size_t ulDepth) {
+   const unsigned char *pucChars;
+   size_t uCache = 0;
+   size_t i;
+
+   pucChars = (const unsigned char *) psKey->pcChars + ulDepth;
+   /* without checking for the end each time, which compilers can
+      make a single load */
+   if(ulDepth + CACHED_CHARS <= psKey->ulLength) {
+      for(i = 0; i < CACHED_CHARS; i++)
+         uCache = (uCache << 8) | pucChars[i];
+   }
+   else {
+      for(i = 0; i < CACHED_CHARS; i++) {
+         uCache <<= 8;
+         if(ulDepth + i < psKey->ulLength)
+            uCache |= pucChars[i];
+      }
+   }
+   psKey->uCache = uCache;
+}
+
+/*
+  Fills the caches of the ulCount keys at psKeys with the characters
+  of their pathnames from ulDepth onward, prefetching the characters
+  of keys further on, as the pathnames are all over memory.
+*/
+static void Path_fillCaches(struct sortKey *psKeys, size_t ulCount,
+                            size_t ulDepth) {
+   size_t i;
+
+   for(i = 0; i < ulCount; i++) {
+      if(i + PREFETCH_DISTANCE < ulCount)
+         PATH_PREFETCH(psKeys[i + PREFETCH_DISTANCE].pcChars + ulDepth);
+      Path_fillCache(&psKeys[i], ulDepth);
+   }
+}
+
+/*
+  Returns the character at index ulOffset of psKey's cache, as a radix
+  sort digit.
+*/
+static size_t Path_getDigit(const struct sortKey *psKey,
+                            size_t ulOffset) {
+   return (psKey->uCache >> (8 * (CACHED_CHARS - 1 - ulOffset))) & 0xFF;
+}
+
+/*
+  Compares the pathnames of *psKey1 and *psKey2, which share their
+  first ulDepth characters and whose caches hold those from there on,
+  as Path_comparePath would.
+*/
+static int Path_compareKeys(const struct sortKey *psKey1,
+                            const struct sortKey *psKey2,
+                            size_t ulDepth) {
+   if(psKey1->uCache != psKey2->uCache)
+      return psKey1->uCache < psKey2->uCache ? -1 : 1;
+   /* equal caches that hold the ends of the pathnames */
+   if((psKey1->uCache & 0xFF) == 0)
+      return 0;
+   ulDepth += CACHED_CHARS;
+   return Path_compareBytes(psKey1->pcChars + ulDepth,
+                            psKey1->ulLength - ulDepth,
+                            psKey2->pcChars + ulDepth,
+                            psKey2->ulLength - ulDepth);
+}
+
+/*
+  Swaps *psKey1 and *psKey2.
+*/
+static void Path_swapKeys(struct sortKey *psKey1,
+                          struct sortKey *psKey2) {
+   struct sortKey sTemp;
+
+   sTemp = *psKey1;
+   *psKey1 = *psKey2;
+   *psKey2 = sTemp;
+}
+
+/*
+  Sorts the ulCount keys at psKeys, whose pathnames all share their
+  first ulDepth characters and whose caches hold those from there on,
+  by insertion.
+*/
+static void Path_insertionSortKeys(struct sortKey *psKeys,
+                                   size_t ulCount, size_t ulDepth) {
+   struct sortKey sKey;
+   size_t i, j;
+
+   for(i = 1; i < ulCount; i++) {
+      sKey = psKeys[i];
+      for(j = i; j > 0; j--) {
+         if(Path_compareKeys(&sKey, &psKeys[j - 1], ulDepth) >= 0)
+            break;
+         psKeys[j] = psKeys[j - 1];
+      }
+      psKeys[j] = sKey;
+   }
+}
+
+/*
+  Sorts the ulCount keys at psKeys, whose pathnames all share their
+  first ulDepth characters and whose caches hold those from there on,
+  by multikey quicksort (Bentley and Sedgewick, "Fast Algorithms for
+  Sorting and Searching Strings") with whole caches as the keys'
+  characters: partitions them three ways on their caches, and reads
+  the next characters of their pathnames only for those equal to the
+  pivot. It recurses into all but the largest part and loops on that
+  one, so it recurses at most log2(ulCount) levels deep.
+*/
+static void Path_multikeySort(struct sortKey *psKeys, size_t ulCount,
+                              size_t ulDepth) {
+   size_t uFirst, uPivot, uLast;
+   size_t ulLess, ulGreater, i;
+   struct sortKey *apsParts[3];
+   size_t aulCounts[3];
+   size_t ulLargest;
+
+   while(ulCount >= MULTIKEY_MIN_COUNT) {
+      /* the median of the first, middle and last caches */
+      uFirst = psKeys[0].uCache;
+      uPivot = psKeys[ulCount / 2].uCache;
+      uLast = psKeys[ulCount - 1].uCache;
+      if((uFirst <= uPivot) != (uPivot <= uLast)) {
+         if((uPivot <= uFirst) == (uFirst <= uLast))
+            uPivot = uFirst;
+         else
+            uPivot = uLast;
+      }
+
+      /* [0, ulLess) are less than the pivot, [ulLess, i) equal to
+         it and [ulGreater, ulCount) greater */
+      ulLess = 0;
+      ulGreater = ulCount;
+      i = 0;
+      while(i < ulGreater) {
+         if(psKeys[i].uCache < uPivot)
+            Path_swapKeys(&psKeys[ulLess++], &psKeys[i++]);
+         else if(psKeys[i].uCache > uPivot)
+            Path_swapKeys(&psKeys[i], &psKeys[--ulGreater]);
+         else
+            i++;
+      }
+
+      apsParts[0] = psKeys;
+      aulCounts[0] = ulLess;
+      apsParts[1] = psKeys + ulLess;
+      aulCounts[1] = ulGreater - ulLess;
+      apsParts[2] = psKeys + ulGreater;
+      aulCounts[2] = ulCount - ulGreater;
+
+      /* keys equal to a pivot that holds the end of their pathnames
+         are equal; the others go on to their next characters */
+      if((uPivot & 0xFF) == 0)
+         aulCounts[1] = 0;
+      else
+         Path_fillCaches(apsParts[1], aulCounts[1],
+                         ulDepth + CACHED_CHARS);
+
+      ulLargest = aulCounts[0] >= aulCounts[2] ? 0 : 2;
+      if(aulCounts[1] > aulCounts[ulLargest])
+         ulLargest = 1;
+      for(i = 0; i < 3; i++)
+         if(i != ulLargest && aulCounts[i] > 1)
+            Path_multikeySort(apsParts[i], aulCounts[i], i == 1 ?
+                              ulDepth + CACHED_CHARS : ulDepth);
+
+      psKeys = apsParts[ulLargest];
+      ulCount = aulCounts[ulLargest];
+      if(ulLargest == 1)
+         ulDepth += CACHED_CHARS;
+   }
+   Path_insertionSortKeys(psKeys, ulCount, ulDepth);
+}
+
+/*
+  Sorts the ulCount keys at psKeys, whose pathnames all share their
+  first ulDepth + ulOffset characters and whose caches hold those from
+  ulDepth on, by most-significant-digit radix sort: distributes them
+  in place into the 256 buckets of the characters at ulOffset in their
+  caches (as in McIlroy, Bostic and McIlroy, "Engineering Radix
+  Sort"), then sorts each bucket on the next character. Bucket 0 holds
+  pathnames that have ended, which are equal. Small buckets go to
+  Path_multikeySort. As there, the largest bucket is looped on rather
+  than recursed into, and a character that all keys share is skipped
+  without moving them.
+*/
+static void Path_radixSort(struct sortKey *psKeys, size_t ulCount,
+                           size_t ulDepth, size_t ulOffset) {
+   size_t aulCounts[256];
+   size_t aulNext[256];
+   size_t aulEnd[256];
+   size_t ulDigit, ulLargest, ulStart, i;
+   size_t ulShared, uDiffer;
+   struct sortKey sKey, sTemp;
+
+   while(ulCount >= RADIX_MIN_COUNT) {
+      if(ulOffset == CACHED_CHARS) {
+         ulDepth += CACHED_CHARS;
+         ulOffset = 0;
+         Path_fillCaches(psKeys, ulCount, ulDepth);
+      }
+
+      memset(aulCounts, 0, sizeof(aulCounts));
+      for(i = 0; i < ulCount; i++)
+         aulCounts[Path_getDigit(&psKeys[i], ulOffset)]++;
+
+      /* if all keys share this character, skip it along with any
+         more that all their caches share */
+      ulDigit = Path_getDigit(&psKeys[0], ulOffset);
+      if(aulCounts[ulDigit] == ulCount) {
+         uDiffer = 0;
+         for(i = 1; i < ulCount; i++)
+            uDiffer |= psKeys[i].uCache ^ psKeys[0].uCache;
+         for(ulShared = ulOffset + 1; ulShared < CACHED_CHARS;
+             ulShared++)
+            if(uDiffer >> (8 * (CACHED_CHARS - 1 - ulShared)) != 0)
+               break;
+         /* a cache holds no characters after a 0, so all pathnames
+            end if the last shared character is one */
+         if(Path_getDigit(&psKeys[0], ulShared - 1) == 0)
+            return;
+         ulOffset = ulShared;
+         continue;
+      }
+
+      ulStart = 0;
+      for(i = 0; i < 256; i++) {
+         aulNext[i] = ulStart;
+         ulStart += aulCounts[i];
+         aulEnd[i] = ulStart;
+      }
+
+      /* move each key that is out of place into the next free place
+         in its bucket, and carry on with the key found there */
+      for(i = 0; i < 256; i++) {
+         while(aulNext[i] < aulEnd[i]) {
+            sKey = psKeys[aulNext[i]];
+            ulDigit = Path_getDigit(&sKey, ulOffset);
+            while(ulDigit != i) {
+               sTemp = psKeys[aulNext[ulDigit]];
+               psKeys[aulNext[ulDigit]++] = sKey;
+               sKey = sTemp;
+               ulDigit = Path_getDigit(&sKey, ulOffset);
+            }
+            psKeys[aulNext[i]++] = sKey;
+         }
+      }
+
+      ulLargest = 1;
+      for(i = 2; i < 256; i++)
+         if(aulCounts[i] > aulCounts[ulLargest])
+            ulLargest = i;
+      for(i = 1; i < 256; i++)
+         if(i != ulLargest && aulCounts[i] > 1)
+            Path_radixSort(psKeys + (aulEnd[i] - aulCounts[i]),
+                           aulCounts[i], ulDepth, ulOffset + 1);
+
+      psKeys += aulEnd[ulLargest] - aulCounts[ulLargest];
+      ulCount = aulCounts[ulLargest];
+      ulOffset++;
+   }
+
+   /* Path_multikeySort compares whole caches, which the keys share up
+      to ulOffset anyway */
+   if(ulOffset == CACHED_CHARS) {
+      ulDepth += CACHED_CHARS;
+      Path_fillCaches(psKeys, ulCount, ulDepth);
+   }
+   Path_multikeySort(psKeys, ulCount, ulDepth);
+}
+
+/*
+  Compares the paths *pvPath1 and *pvPath2 as Path_comparePath does,
+  for DynArray_sort.
+*/
+static int Path_compareElements(const void *pvPath1,
+                                const void *pvPath2) {
+   return Path_comparePath((Path_T) pvPath1, (Path_T) pvPath2);
+}
+
+/*
+  Compares the pathnames pvPathname1 and pvPathname2 as strcmp does,
+  for DynArray_sort.
+*/
+static int Path_comparePathnames(const void *pvPathname1,
+                                 const void *pvPathname2) {
+   return strcmp((const char *) pvPathname1,
+                 (const char *) pvPathname2);
+}
+
+/*
+  Sorts oArray, whose elements are paths if iPaths is TRUE or
+  pathnames otherwise, by radix sorting a table of their pathnames,
+  which spares reading each element again for every character, and
+  whose caches spare reading most characters from the pathnames
+  themselves. Falls back on DynArray_sort if memory for the table is
+  not available.
+*/
+static void Path_sortArray(DynArray_T oArray, boolean iPaths) {
+   struct sortKey *psKeys;
+   void **ppvElements;
+   size_t ulCount, i;
+
+   assert(oArray != NULL);
+
+   ulCount = DynArray_getLength(oArray);
+   if(ulCount < 2)
+      return;
+
+   psKeys = Arena_alloc(NULL, ulCount * sizeof(struct sortKey));
+   if(psKeys == NULL) {
+      DynArray_sort(oArray, iPaths ? Path_compareElements :
+                    Path_comparePathnames);
+      return;
+   }
+
+   ppvElements = DynArray_getArray(oArray);
+   for(i = 0; i < ulCount; i++) {
+      assert(ppvElements[i] != NULL);
+      if(i + PREFETCH_DISTANCE < ulCount)
+         PATH_PREFETCH(ppvElements[i + PREFETCH_DISTANCE]);
+      if(iPaths) {
+         psKeys[i].pcChars = ((Path_T) ppvElements[i])->pcPath;
+         psKeys[i].ulLength = ((Path_T) ppvElements[i])->ulLength;
+      }
+      else {
+         psKeys[i].pcChars = ppvElements[i];
+         psKeys[i].ulLength = strlen(ppvElements[i]);
+      }
+      psKeys[i].pvElement = ppvElements[i];
+      Path_fillCache(&psKeys[i], 0);
+   }
+
+   Path_radixSort(psKeys, ulCount, 0, 0);
+
+   for(i = 0; i < ulCount; i++)
+      ppvElements[i] = psKeys[i].pvElement;
+   Arena_release(NULL, psKeys, ulCount * sizeof(struct sortKey));
+}
+
+void Path_sortPaths(DynArray_T oPaths) {
+   Path_sortArray(oPaths, TRUE);
+}
+
+void Path_sortPathnames(DynArray_T oPathnames) {
+   Path_sortArray(oPathnames, FALSE);
 }
 
 size_t Path_getDepth(Path_T oPPath) {
    assert(oPPath != NULL);
 
-   return DynArray_getLength(oPPath->oDComponents);
+   return oPPath->ulDepth;
 }
 
 size_t Path_getSharedPrefixDepth(Path_T oPPath1, Path_T oPPath2) {
-   size_t ulDepth1, ulDepth2, ulMin, i;
+   const struct component *psComponent1, *psComponent2;
+   size_t ulMin, i;
 
    assert(oPPath1 != NULL);
    assert(oPPath2 != NULL);
 
-   ulDepth1 = Path_getDepth(oPPath1);
-   ulDepth2 = Path_getDepth(oPPath2);
-   if(ulDepth1 < ulDepth2)
-      ulMin = ulDepth1;
+   if(oPPath1->ulDepth < oPPath2->ulDepth)
+      ulMin = oPPath1->ulDepth;
    else
-      ulMin = ulDepth2;
+      ulMin = oPPath2->ulDepth;
    for(i = 0; i < ulMin; i++) {
-      if(strcmp(Path_getComponent(oPPath1, i),
-                Path_getComponent(oPPath2, i)))
+      psComponent1 = &oPPath1->psComponents[i];
+      psComponent2 = &oPPath2->psComponents[i];
+      if(psComponent1->ulLength != psComponent2->ulLength ||
+         memcmp(oPPath1->pcPath + psComponent1->ulOffset,
+                oPPath2->pcPath + psComponent2->ulOffset,
+                psComponent1->ulLength) != 0)
          return i;
    }
    return ulMin;
@@ -309,8 +1295,107 @@ size_t Path_getSharedPrefixDepth(Path_T oPPath1, Path_T oPPath2) {
 const char *Path_getComponent(Path_T oPPath, size_t ulLevel) {
    assert(oPPath != NULL);
 
-   if(ulLevel >= Path_getDepth(oPPath))
+   if(ulLevel >= oPPath->ulDepth)
       return NULL;
 
-   return DynArray_get(oPPath->oDComponents, ulLevel);
+   return oPPath->pcComponents + oPPath->psComponents[ulLevel].ulOffset;
+}
+
+size_t Path_getComponentLength(Path_T oPPath, size_t ulLevel) {
+   assert(oPPath != NULL);
+   assert(ulLevel < oPPath->ulDepth);
+
+   return oPPath->psComponents[ulLevel].ulLength;
+}
+
+size_t Path_getComponentHash(Path_T oPPath, size_t ulLevel) {
+   assert(oPPath != NULL);
+   assert(ulLevel < oPPath->ulDepth);
+
+   return oPPath->psComponents[ulLevel].uHash;
+}
+
+int PathView_init(struct pathView *psView, const char *pcPath) {
+   assert(psView != NULL);
+   assert(pcPath != NULL);
+
+   psView->pcPath = pcPath;
+   psView->ulLastLevel = 0;
+   psView->ulLastOffset = 0;
+   return Path_scan(pcPath, &psView->ulDepth, &psView->ulLength,
+                    psView->aulOffsets, PATH_VIEW_INLINE_DEPTH);
+}
+
+const char *PathView_getPathname(const struct pathView *psView) {
+   assert(psView != NULL);
+
+   return psView->pcPath;
+}
+
+size_t PathView_getStrLength(const struct pathView *psView) {
+   assert(psView != NULL);
+
+   return psView->ulLength;
+}
+
+size_t PathView_getDepth(const struct pathView *psView) {
+   assert(psView != NULL);
+
+   return psView->ulDepth;
+}
+
+const char *PathView_getComponent(struct pathView *psView,
+                                  size_t ulLevel, size_t *pulLength) {
+   const char *pcStart;
+   const char *pcEnd;
+   size_t ulKnown, ulOffset;
+
+   assert(psView != NULL);
+   assert(pulLength != NULL);
+
+   if(ulLevel >= psView->ulDepth)
+      return NULL;
+
+   /* start from the nearest component whose offset is known */
+   if(ulLevel < PATH_VIEW_INLINE_DEPTH) {
+      ulKnown = ulLevel;
+      ulOffset = psView->aulOffsets[ulLevel];
+   }
+   else if(psView->ulLastLevel >= PATH_VIEW_INLINE_DEPTH &&
+           psView->ulLastLevel <= ulLevel) {
+      ulKnown = psView->ulLastLevel;
+      ulOffset = psView->ulLastOffset;
+   }
+   else {
+      ulKnown = PATH_VIEW_INLINE_DEPTH - 1;
+      ulOffset = psView->aulOffsets[ulKnown];
+   }
+   pcStart = psView->pcPath + ulOffset;
+   for(; ulKnown < ulLevel; ulKnown++)
+      pcStart = strchr(pcStart, '/') + 1;
+   psView->ulLastLevel = ulLevel;
+   psView->ulLastOffset = (size_t) (pcStart - psView->pcPath);
+
+   pcEnd = pcStart;
+   while(*pcEnd != '/' && *pcEnd != '\0')
+      pcEnd++;
+   *pulLength = (size_t) (pcEnd - pcStart);
+   return pcStart;
+}
+
+int PathView_comparePath(const struct pathView *psView, Path_T oPPath) {
+   assert(psView != NULL);
+   assert(oPPath != NULL);
+
+   return Path_compareBytes(psView->pcPath, psView->ulLength,
+                            oPPath->pcPath, oPPath->ulLength);
+}
+
+int PathView_compareString(const struct pathView *psView,
+                           const char *pcStr) {
+   assert(psView != NULL);
+   assert(pcStr != NULL);
+
+   return Path_compareBytes(psView->pcPath, psView->ulLength,
+                            pcStr, strlen(pcStr));
 }
@@ -8,8 +8,17 @@
 
 #include <stddef.h>
 #include "a4def.h"
+#include "arena.h"
+#include "dynarray.h"
 
-/* An object representing an absolute path in a tree */
+/*
+  An object representing an absolute path in a tree. Paths are
+  immutable and reference counted, so copies and prefixes of a path
+  share its memory instead of copying it. The reference counts are
+  not atomic, and Path_new may share paths through the parsed-path
+  cache, so the path module is for one thread at a time: a threaded
+  client must not use it from two threads at once.
+*/
 typedef const struct path * Path_T;
 
 /*
@@ -24,18 +33,75 @@ typedef const struct path * Path_T;
 int Path_new(const char *pcPath, Path_T *poPResult);
 
 /*
-  Creates a "deep copy" of oPPath, duplicating all its contents.
+  Creates a new path object like Path_new, but allocates all of its
+  memory from oArena, which must outlive it. Path_free gives that
+  memory back to oArena. Path_new(pcPath, poPResult) is
+  Path_newIn(NULL, pcPath, poPResult).
+*/
+int Path_newIn(Arena_T oArena, const char *pcPath, Path_T *poPResult);
+
+/*
+  Creates a new path object of ulDepth components, and of string length
+  ulLength, from its components rather than from its pathname, writing
+  the pathname straight into the path's own memory from oArena, which
+  must outlive it. The path is built from its end: each of ulDepth
+  calls (*pfGetPrev)(pvState, &pcName, &ulNameLength) must give the
+  component before the one the previous call gave, starting with the
+  last, as the ulNameLength characters at pcName, which must be no '/'.
   Returns an int SUCCESS status and sets *poPResult to be the new path
-  if successful. Otherwise, sets *poPResult to NULL and returns status:
-  * MEMORY_ERROR if memory could not be allocated to complete request
-  * NO_SUCH_PATH if oPPath's depth is 0
+  if successful. Otherwise, sets *poPResult to NULL and returns
+  MEMORY_ERROR, if memory could not be allocated to complete request.
+*/
+int Path_build(Arena_T oArena, size_t ulDepth, size_t ulLength,
+               void (*pfGetPrev)(void *pvState, const char **ppcName,
+                                 size_t *pulNameLength),
+               void *pvState, Path_T *poPResult);
+
+/*
+  Sets up the parsed-path cache, which is off to begin with, to hold
+  the paths of the ulCapacity pathnames that Path_new was most
+  recently given. Path_new answers a pathname in the cache with a
+  copy of its path, as Path_dup makes, without parsing it again.
+  Paths from an arena are never cached. Whatever the cache held
+  before is dropped, and its counters start again from 0; a capacity
+  of 0 turns the cache off and frees it. Returns SUCCESS, or
+  MEMORY_ERROR (leaving the cache as it was) if memory could not be
+  allocated for it. The cache is state of the whole process, which
+  every Path_new call reads and updates while it is on, and it is not
+  guarded against threads.
+*/
+int Path_setCacheCapacity(size_t ulCapacity);
+
+/*
+  Sets *pulHits and *pulMisses to the numbers of Path_new calls that
+  the parsed-path cache has, and has not, answered since it was set
+  up.
+*/
+void Path_getCacheStats(size_t *pulHits, size_t *pulMisses);
+
+/*
+  Sets *pulAllocs and *pulBytes to the numbers of allocations that
+  this module has made for paths since the program started, and of
+  bytes in them: path blocks, prefix structs and pathname copies,
+  whether from the heap or an arena. Like the cache, the counters are
+  state of the whole process and are not guarded against threads.
+*/
+void Path_getAllocStats(size_t *pulAllocs, size_t *pulBytes);
+
+/*
+  Creates a copy of oPPath, which is another reference to it and costs
+  neither memory nor time. Returns an int SUCCESS status and sets
+  *poPResult to be the copy, which Path_free must free like any path.
 */
 int Path_dup(Path_T oPPath, Path_T *poPResult);
 
 /*
   Creates a new path object representing a prefix (i.e., ancestor) of
   oPPath with depth ulDepth. In the case that ulDepth is the same as
-  oPPath's depth, this is equivalent to Path_dup.
+  oPPath's depth, this is equivalent to Path_dup. Otherwise the prefix
+  comes from the same arena as oPPath and shares oPPath's memory, but
+  for a '\0'-terminated copy of its pathname, which Path_getPathname
+  returns.
   Returns an int SUCCESS status and sets *poPResult to be the new path
   if successful. Otherwise, sets *poPResult to NULL and returns status:
   * MEMORY_ERROR if memory could not be allocated to complete request
@@ -43,10 +109,29 @@ int Path_dup(Path_T oPPath, Path_T *poPResult);
 */
 int Path_prefix(Path_T oPPath, size_t ulDepth, Path_T *poPResult);
 
-/* Destroys and frees all memory allocated for oPPath. */
+/*
+  Creates a prefix of oPPath like Path_prefix, but from oArena, which
+  must outlive it. If oPPath comes from oArena too, the prefix shares
+  all of its memory, so creating it takes constant time, but it has no
+  pathname string of its own: read it with Path_getChars and
+  Path_getStrLength, not Path_getPathname. Otherwise it is a copy, so
+  that neither path holds on to memory in the other's arena.
+*/
+int Path_prefixIn(Arena_T oArena, Path_T oPPath, size_t ulDepth,
+                  Path_T *poPResult);
+
+/*
+  Gives up a reference to oPPath, and destroys and frees all memory
+  allocated for it once the last reference to it or its prefixes is
+  gone.
+*/
 void Path_free(Path_T oPPath);
 
-/* Returns the string representation of the absolute path oPPath. */
+/*
+  Returns the string representation of the absolute path oPPath,
+  which must not be a prefix that Path_prefixIn made to share another
+  path's memory.
+*/
 const char *Path_getPathname(Path_T oPPath);
 
 /*
@@ -55,6 +140,14 @@ const char *Path_getPathname(Path_T oPPath);
 */
 size_t Path_getStrLength(Path_T oPPath);
 
+/*
+  Returns the characters of the string representation of oPPath, of
+  which there are Path_getStrLength. Unlike Path_getPathname, it works
+  for every path, but the characters of a prefix that shares another
+  path's memory are not '\0'-terminated.
+*/
+const char *Path_getChars(Path_T oPPath);
+
 /*
   Compares oPPath1 and oPPath2 lexicographically based on pathname.
   Returns <0, 0, or >0 if oPPath1 is "less than", "equal to", or
@@ -69,6 +162,20 @@ int Path_comparePath(Path_T oPPath1, Path_T oPPath2);
 */
 int Path_compareString(Path_T oPPath, const char *pcStr);
 
+/*
+  Sorts oPaths, a DynArray_T of paths, in the order of
+  Path_comparePath, by radix sort on their pathnames' characters
+  rather than by comparisons, which is several times faster for many
+  paths.
+*/
+void Path_sortPaths(DynArray_T oPaths);
+
+/*
+  Sorts oPathnames, a DynArray_T of pathname strings, in the same way
+  as Path_sortPaths, and so also in the order of strcmp.
+*/
+void Path_sortPathnames(DynArray_T oPathnames);
+
 /*
   Returns the number of separate levels (components) in oPPath.
   For example, the absolute path "someRoot" has depth 1, and
@@ -93,4 +200,83 @@ size_t Path_getSharedPrefixDepth(Path_T oPPath1, Path_T oPPath2);
 */
 const char *Path_getComponent(Path_T oPPath, size_t ulLevel);
 
+/*
+  Returns the string length of the component of oPPath at level
+  ulLevel, which must be less than oPPath's depth.
+*/
+size_t Path_getComponentLength(Path_T oPPath, size_t ulLevel);
+
+/*
+  Returns the hash code of the component of oPPath at level ulLevel,
+  which must be less than oPPath's depth. The code is computed when
+  oPPath is, and is the component's HashTable_hash.
+*/
+size_t Path_getComponentHash(Path_T oPPath, size_t ulLevel);
+
+/*
+  The number of components whose offsets a pathView records itself.
+  Deeper components are found by scanning on from the last of those,
+  or from the last one asked for, so walking them in order stays
+  linear.
+*/
+#define PATH_VIEW_INLINE_DEPTH 32
+
+/*
+  A read-only view of an absolute path in a string that the caller
+  owns, for lookups that have no use for a Path_T of their own. A
+  pathView is meant to live on the stack: it copies nothing and
+  allocates nothing, and is valid for as long as its string is. Its
+  fields are private to path.c.
+*/
+struct pathView {
+   const char *pcPath;
+   size_t ulLength;
+   size_t ulDepth;
+   size_t aulOffsets[PATH_VIEW_INLINE_DEPTH];
+   size_t ulLastLevel;
+   size_t ulLastOffset;
+};
+
+/*
+  Sets up *psView as a view of the absolute path in pcPath. Returns
+  SUCCESS, or BAD_PATH (leaving *psView unusable) if pcPath is the
+  empty string or begins with or ends with a '/' or contains
+  consecutive '/' delimiters.
+*/
+int PathView_init(struct pathView *psView, const char *pcPath);
+
+/* Returns the string representation of the path psView views. */
+const char *PathView_getPathname(const struct pathView *psView);
+
+/*
+  Returns the length (not including trailing '\0') of the string
+  representation of the path psView views.
+*/
+size_t PathView_getStrLength(const struct pathView *psView);
+
+/* Returns the number of separate levels (components) in psView. */
+size_t PathView_getDepth(const struct pathView *psView);
+
+/*
+  Returns a pointer to the first character of the component of psView
+  at level ulLevel, counting from 0, and sets *pulLength to its length.
+  The component is not '\0'-terminated. Returns NULL if ulLevel is
+  greater than psView's maximum level.
+*/
+const char *PathView_getComponent(struct pathView *psView,
+                                  size_t ulLevel, size_t *pulLength);
+
+/*
+  Compares the pathname of psView with that of oPPath
+  lexicographically, as Path_comparePath does.
+*/
+int PathView_comparePath(const struct pathView *psView, Path_T oPPath);
+
+/*
+  Compares the pathname of psView with pcStr lexicographically, as
+  Path_compareString does.
+*/
+int PathView_compareString(const struct pathView *psView,
+                           const char *pcStr);
+
 #endif
@@ -0,0 +1,523 @@
+/*--------------------------------------------------------------------*/
+/* typedarray.h                                                       */
+/* Author: Roy Mazumder and Roshaan Khalid                            */
+/*--------------------------------------------------------------------*/
+
+#ifndef TYPEDARRAY_INCLUDED
+#define TYPEDARRAY_INCLUDED
+
+#include <stddef.h>
+#include "dynarray.h"
+
+/* These macros generate typed variants of the DynArray functions for
+   a DynArray_T whose elements are all of one pointer type, Type.  The
+   variants take and return Type instead of void*, and those that
+   compare elements call the comparison function they are given
+   directly, so that the compiler can inline it instead of calling
+   through a function pointer for every comparison.  The array is
+   still a DynArray_T, made, grown and freed by the DynArray
+   functions.  Each macro is used at most once per Name, at file scope
+   in a .c file, and generates static functions named Name_...; the
+   comparison functions must be declared with prototypes before it. */
+
+#ifdef __GNUC__
+#define TYPEDARRAY_UNUSED __attribute__((unused))
+#define TYPEDARRAY_PREFETCH(pv) __builtin_prefetch(pv)
+#else
+#define TYPEDARRAY_UNUSED
+#define TYPEDARRAY_PREFETCH(pv) ((void)0)
+#endif
+
+/* The thresholds of the generated sorts. */
+
+#define TYPEDARRAY_INSERTION_SORT_LENGTH 24
+#define TYPEDARRAY_NINTHER_LENGTH 128
+#define TYPEDARRAY_PARTIAL_INSERTION_LIMIT 8
+
+/*--------------------------------------------------------------------*/
+
+/* Generate, for DynArray_T objects whose elements are of type Type,
+      Type Name_get(DynArray_T oDynArray, size_t uIndex);
+      int Name_add(DynArray_T oDynArray, Type tElement);
+      int Name_addAt(DynArray_T oDynArray, size_t uIndex,
+                     Type tElement);
+      Type Name_removeAt(DynArray_T oDynArray, size_t uIndex);
+   which do what the DynArray functions of the same names do. */
+
+#define DYNARRAY_DEFINE_TYPE(Name, Type)                               \
+                                                                       \
+static TYPEDARRAY_UNUSED Type Name##_get(DynArray_T oDynArray,         \
+                                         size_t uIndex)                \
+{                                                                      \
+   return DynArray_get(oDynArray, uIndex);                             \
+}                                                                      \
+                                                                       \
+static TYPEDARRAY_UNUSED int Name##_add(DynArray_T oDynArray,          \
+                                        Type tElement)                 \
+{                                                                      \
+   return DynArray_add(oDynArray, tElement);                           \
+}                                                                      \
+                                                                       \
+static TYPEDARRAY_UNUSED int Name##_addAt(DynArray_T oDynArray,        \
+                                          size_t uIndex,               \
+                                          Type tElement)               \
+{                                                                      \
+   return DynArray_addAt(oDynArray, uIndex, tElement);                 \
+}                                                                      \
+                                                                       \
+static TYPEDARRAY_UNUSED Type Name##_removeAt(DynArray_T oDynArray,    \
+                                              size_t uIndex)           \
+{                                                                      \
+   return DynArray_removeAt(oDynArray, uIndex);                        \
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Generate
+      void Name_sortElements(void **ppvLo, void **ppvHi, Context ctx);
+   which sorts the elements at addresses ppvLo...ppvHi-1 by
+   pattern-defeating quicksort, as DynArray_sort describes, in the
+   order determined by
+      int pfCompareWith(Context ctx, void *pvElement1,
+                        void *pvElement2),
+   which is called directly and given the ctx that Name_sortElements
+   is given.  DYNARRAY_DEFINE_SORT uses it with an unused ctx, and
+   dynarray.c with ctx the comparison function that the DynArray
+   functions are given, so that there is one implementation of the
+   sort. */
+
+#define DYNARRAY_DEFINE_SORT_WITH(Name, Context, pfCompareWith)        \
+                                                                       \
+static void Name##_swap(void **ppvElement1, void **ppvElement2)        \
+{                                                                      \
+   void *pvTemp;                                                       \
+                                                                       \
+   pvTemp = *ppvElement1;                                              \
+   *ppvElement1 = *ppvElement2;                                        \
+   *ppvElement2 = pvTemp;                                              \
+}                                                                      \
+                                                                       \
+static void Name##_sort3(void **ppvElement1, void **ppvElement2,       \
+                         void **ppvElement3, Context ctx)              \
+{                                                                      \
+   /* Sort the three elements in ascending order. */                   \
+                                                                       \
+   if (pfCompareWith(ctx, *ppvElement2, *ppvElement1) < 0)             \
+      Name##_swap(ppvElement1, ppvElement2);                           \
+   if (pfCompareWith(ctx, *ppvElement3, *ppvElement2) < 0)             \
+   {                                                                   \
+      Name##_swap(ppvElement2, ppvElement3);                           \
+      if (pfCompareWith(ctx, *ppvElement2, *ppvElement1) < 0)          \
+         Name##_swap(ppvElement1, ppvElement2);                        \
+   }                                                                   \
+}                                                                      \
+                                                                       \
+static int Name##_insertionSort(void **ppvLo, void **ppvHi,            \
+                                int iLeftmost, size_t uLimit,          \
+                                Context ctx)                           \
+{                                                                      \
+   /* Sort the elements at addresses ppvLo...ppvHi-1 by insertion.     \
+      If iLeftmost is 0 (FALSE), the element at ppvLo-1 must not be    \
+      greater than any of them, which spares checking for ppvLo while  \
+      moving them down.  If uLimit is not 0, give up, leaving them     \
+      unsorted, and return 0 (FALSE) once more than uLimit elements    \
+      have moved; otherwise return 1 (TRUE). */                        \
+                                                                       \
+   void **ppvNext;                                                     \
+   void **ppvHole;                                                     \
+   void *pvElement;                                                    \
+   size_t uMoved = 0;                                                  \
+                                                                       \
+   for (ppvNext = ppvLo + 1; ppvNext < ppvHi; ppvNext++)               \
+   {                                                                   \
+      pvElement = *ppvNext;                                            \
+      ppvHole = ppvNext;                                               \
+      while ((! iLeftmost || ppvHole > ppvLo) &&                       \
+             pfCompareWith(ctx, pvElement, *(ppvHole - 1)) < 0)        \
+      {                                                                \
+         *ppvHole = *(ppvHole - 1);                                    \
+         ppvHole--;                                                    \
+      }                                                                \
+      *ppvHole = pvElement;                                            \
+                                                                       \
+      uMoved += (size_t)(ppvNext - ppvHole);                           \
+      if (uLimit != 0 && uMoved > uLimit)                              \
+         return 0;                                                     \
+   }                                                                   \
+   return 1;                                                           \
+}                                                                      \
+                                                                       \
+static void Name##_siftDown(void **ppvHeap, size_t uRoot,              \
+                            size_t uLength, Context ctx)               \
+{                                                                      \
+   /* Move the element at ppvHeap[uRoot] down the heap of uLength      \
+      elements at ppvHeap, with the greatest element at its root,      \
+      until it is not less than its children. */                       \
+                                                                       \
+   void *pvElement;                                                    \
+   size_t uChild;                                                      \
+                                                                       \
+   pvElement = ppvHeap[uRoot];                                         \
+   while ((uChild = 2 * uRoot + 1) < uLength)                          \
+   {                                                                   \
+      if (uChild + 1 < uLength &&                                      \
+          pfCompareWith(ctx, ppvHeap[uChild],                          \
+                        ppvHeap[uChild + 1]) < 0)                      \
+         uChild++;                                                     \
+      if (pfCompareWith(ctx, pvElement, ppvHeap[uChild]) >= 0)         \
+         break;                                                        \
+      ppvHeap[uRoot] = ppvHeap[uChild];                                \
+      uRoot = uChild;                                                  \
+   }                                                                   \
+   ppvHeap[uRoot] = pvElement;                                         \
+}                                                                      \
+                                                                       \
+static void Name##_heapSort(void **ppvLo, void **ppvHi, Context ctx)   \
+{                                                                      \
+   size_t uLength;                                                     \
+   size_t u;                                                           \
+                                                                       \
+   uLength = (size_t)(ppvHi - ppvLo);                                  \
+   for (u = uLength / 2; u > 0; u--)                                   \
+      Name##_siftDown(ppvLo, u - 1, uLength, ctx);                     \
+   for (u = uLength; u > 1; u--)                                       \
+   {                                                                   \
+      Name##_swap(ppvLo, ppvLo + u - 1);                               \
+      Name##_siftDown(ppvLo, 0, u - 1, ctx);                           \
+   }                                                                   \
+}                                                                      \
+                                                                       \
+static void **Name##_partitionRight(void **ppvLo, void **ppvHi,        \
+                                    int *piPartitioned, Context ctx)   \
+{                                                                      \
+   /* Move the elements less than the pivot *ppvLo before it and the   \
+      others after it.  Some element after ppvLo must not be less      \
+      than the pivot.  Return the address where the pivot ends up,     \
+      and assign 1 (TRUE) to *piPartitioned if the elements were       \
+      partitioned already, or 0 (FALSE) otherwise. */                  \
+                                                                       \
+   void *pvPivot;                                                      \
+   void **ppvFirst;                                                    \
+   void **ppvLast;                                                     \
+                                                                       \
+   pvPivot = *ppvLo;                                                   \
+   ppvFirst = ppvLo;                                                   \
+   ppvLast = ppvHi;                                                    \
+                                                                       \
+   /* Find the first element not less than the pivot, then the last    \
+      element less than it, which needs checking for ppvFirst only     \
+      if no element before ppvFirst is less than the pivot. */         \
+   while (pfCompareWith(ctx, *++ppvFirst, pvPivot) < 0)                \
+      ;                                                                \
+   if (ppvFirst - 1 == ppvLo)                                          \
+   {                                                                   \
+      while (ppvFirst < ppvLast &&                                     \
+             pfCompareWith(ctx, *--ppvLast, pvPivot) >= 0)             \
+         ;                                                             \
+   }                                                                   \
+   else                                                                \
+   {                                                                   \
+      while (pfCompareWith(ctx, *--ppvLast, pvPivot) >= 0)             \
+         ;                                                             \
+   }                                                                   \
+                                                                       \
+   *piPartitioned = ppvFirst >= ppvLast;                               \
+                                                                       \
+   /* Swap the elements that are on the wrong sides, which, once       \
+      there is one of each, bound the searches for the next ones. */   \
+   while (ppvFirst < ppvLast)                                          \
+   {                                                                   \
+      Name##_swap(ppvFirst, ppvLast);                                  \
+      while (pfCompareWith(ctx, *++ppvFirst, pvPivot) < 0)             \
+         ;                                                             \
+      while (pfCompareWith(ctx, *--ppvLast, pvPivot) >= 0)             \
+         ;                                                             \
+   }                                                                   \
+                                                                       \
+   *ppvLo = *(ppvFirst - 1);                                           \
+   *(ppvFirst - 1) = pvPivot;                                          \
+   return ppvFirst - 1;                                                \
+}                                                                      \
+                                                                       \
+static void **Name##_partitionLeft(void **ppvLo, void **ppvHi,         \
+                                   Context ctx)                        \
+{                                                                      \
+   /* Move the elements greater than the pivot *ppvLo after it and     \
+      the others before it.  Return the address where the pivot ends   \
+      up. */                                                           \
+                                                                       \
+   void *pvPivot;                                                      \
+   void **ppvFirst;                                                    \
+   void **ppvLast;                                                     \
+                                                                       \
+   pvPivot = *ppvLo;                                                   \
+   ppvFirst = ppvLo;                                                   \
+   ppvLast = ppvHi;                                                    \
+                                                                       \
+   while (pfCompareWith(ctx, pvPivot, *--ppvLast) < 0)                 \
+      ;                                                                \
+   if (ppvLast + 1 == ppvHi)                                           \
+   {                                                                   \
+      while (ppvFirst < ppvLast &&                                     \
+             pfCompareWith(ctx, pvPivot, *++ppvFirst) >= 0)            \
+         ;                                                             \
+   }                                                                   \
+   else                                                                \
+   {                                                                   \
+      while (pfCompareWith(ctx, pvPivot, *++ppvFirst) >= 0)            \
+         ;                                                             \
+   }                                                                   \
+                                                                       \
+   while (ppvFirst < ppvLast)                                          \
+   {                                                                   \
+      Name##_swap(ppvFirst, ppvLast);                                  \
+      while (pfCompareWith(ctx, pvPivot, *--ppvLast) < 0)              \
+         ;                                                             \
+      while (pfCompareWith(ctx, pvPivot, *++ppvFirst) >= 0)            \
+         ;                                                             \
+   }                                                                   \
+                                                                       \
+   *ppvLo = *ppvLast;                                                  \
+   *ppvLast = pvPivot;                                                 \
+   return ppvLast;                                                     \
+}                                                                      \
+                                                                       \
+static void Name##_shuffle(void **ppvLo, size_t uLength)               \
+{                                                                      \
+   /* Swap a few of the uLength elements at ppvLo, which are at least  \
+      TYPEDARRAY_INSERTION_SORT_LENGTH, with others a quarter of the   \
+      way in from either end, to break up whatever pattern made them   \
+      partition badly. */                                              \
+                                                                       \
+   void **ppvHi;                                                       \
+   size_t uQuarter;                                                    \
+                                                                       \
+   ppvHi = ppvLo + uLength;                                            \
+   uQuarter = uLength / 4;                                             \
+                                                                       \
+   Name##_swap(ppvLo, ppvLo + uQuarter);                               \
+   Name##_swap(ppvHi - 1, ppvHi - uQuarter);                           \
+   if (uLength > TYPEDARRAY_NINTHER_LENGTH)                            \
+   {                                                                   \
+      Name##_swap(ppvLo + 1, ppvLo + (uQuarter + 1));                  \
+      Name##_swap(ppvLo + 2, ppvLo + (uQuarter + 2));                  \
+      Name##_swap(ppvHi - 2, ppvHi - (uQuarter + 1));                  \
+      Name##_swap(ppvHi - 3, ppvHi - (uQuarter + 2));                  \
+   }                                                                   \
+}                                                                      \
+                                                                       \
+static void Name##_pdqsort(void **ppvLo, void **ppvHi,                 \
+                           int iBadAllowed, int iLeftmost,             \
+                           Context ctx)                                \
+{                                                                      \
+   /* This function implements the pattern-defeating quicksort         \
+      algorithm described by Orson Peters in "Pattern-defeating        \
+      Quicksort" (2021).  Once iBadAllowed partitions have been badly  \
+      unbalanced, it sorts what is left by heapsort instead.  If       \
+      iLeftmost is 0 (FALSE), the element at ppvLo-1 must not be       \
+      greater than any of the elements.  It recurses into the shorter  \
+      side of each partition and loops on the longer, so it recurses   \
+      at most log2(ppvHi - ppvLo) levels deep. */                      \
+                                                                       \
+   size_t uLength;                                                     \
+   size_t uHalf;                                                       \
+   size_t uLeftLength;                                                 \
+   size_t uRightLength;                                                \
+   void **ppvPivot;                                                    \
+   int iPartitioned;                                                   \
+                                                                       \
+   for (;;)                                                            \
+   {                                                                   \
+      uLength = (size_t)(ppvHi - ppvLo);                               \
+      if (uLength <= TYPEDARRAY_INSERTION_SORT_LENGTH)                 \
+      {                                                                \
+         Name##_insertionSort(ppvLo, ppvHi, iLeftmost, 0, ctx);        \
+         return;                                                       \
+      }                                                                \
+                                                                       \
+      /* Move the median of three elements, or the pseudomedian of     \
+         nine, to ppvLo to be the pivot. */                            \
+      uHalf = uLength / 2;                                             \
+      if (uLength > TYPEDARRAY_NINTHER_LENGTH)                         \
+      {                                                                \
+         Name##_sort3(ppvLo, ppvLo + uHalf, ppvHi - 1, ctx);           \
+         Name##_sort3(ppvLo + 1, ppvLo + (uHalf - 1), ppvHi - 2, ctx); \
+         Name##_sort3(ppvLo + 2, ppvLo + (uHalf + 1), ppvHi - 3, ctx); \
+         Name##_sort3(ppvLo + (uHalf - 1), ppvLo + uHalf,              \
+                      ppvLo + (uHalf + 1), ctx);                       \
+         Name##_swap(ppvLo, ppvLo + uHalf);                            \
+      }                                                                \
+      else                                                             \
+         Name##_sort3(ppvLo + uHalf, ppvLo, ppvHi - 1, ctx);           \
+                                                                       \
+      /* If the element before the range is equal to the pivot, no     \
+         element of the range is less than it, so put those equal to   \
+         it first and leave them be.  This makes runs of equal         \
+         elements cost linear time. */                                 \
+      if (! iLeftmost &&                                               \
+          pfCompareWith(ctx, *(ppvLo - 1), *ppvLo) >= 0)               \
+      {                                                                \
+         ppvLo = Name##_partitionLeft(ppvLo, ppvHi, ctx) + 1;          \
+         continue;                                                     \
+      }                                                                \
+                                                                       \
+      ppvPivot = Name##_partitionRight(ppvLo, ppvHi, &iPartitioned,    \
+                                       ctx);                           \
+      uLeftLength = (size_t)(ppvPivot - ppvLo);                        \
+      uRightLength = (size_t)(ppvHi - (ppvPivot + 1));                 \
+                                                                       \
+      if (uLeftLength < uLength / 8 || uRightLength < uLength / 8)     \
+      {                                                                \
+         /* The partition was badly unbalanced: give up on quicksort   \
+            if that has happened too often, or else shuffle both       \
+            sides so the next pivots are likely to do better. */       \
+         if (--iBadAllowed == 0)                                       \
+         {                                                             \
+            Name##_heapSort(ppvLo, ppvHi, ctx);                        \
+            return;                                                    \
+         }                                                             \
+         if (uLeftLength >= TYPEDARRAY_INSERTION_SORT_LENGTH)          \
+            Name##_shuffle(ppvLo, uLeftLength);                        \
+         if (uRightLength >= TYPEDARRAY_INSERTION_SORT_LENGTH)         \
+            Name##_shuffle(ppvPivot + 1, uRightLength);                \
+      }                                                                \
+      else if (iPartitioned &&                                         \
+               Name##_insertionSort(ppvLo, ppvPivot, 1,                \
+                  TYPEDARRAY_PARTIAL_INSERTION_LIMIT, ctx) &&          \
+               Name##_insertionSort(ppvPivot + 1, ppvHi, 1,            \
+                  TYPEDARRAY_PARTIAL_INSERTION_LIMIT, ctx))            \
+         /* The elements were partitioned already and nearly sorted    \
+            on both sides, so they are sorted now. */                  \
+         return;                                                       \
+                                                                       \
+      if (uLeftLength < uRightLength)                                  \
+      {                                                                \
+         Name##_pdqsort(ppvLo, ppvPivot, iBadAllowed, iLeftmost, ctx); \
+         ppvLo = ppvPivot + 1;                                         \
+         iLeftmost = 0;                                                \
+      }                                                                \
+      else                                                             \
+      {                                                                \
+         Name##_pdqsort(ppvPivot + 1, ppvHi, iBadAllowed, 0, ctx);     \
+         ppvHi = ppvPivot;                                             \
+      }                                                                \
+   }                                                                   \
+}                                                                      \
+                                                                       \
+static void Name##_sortElements(void **ppvLo, void **ppvHi,            \
+                                Context ctx)                           \
+{                                                                      \
+   size_t uLength;                                                     \
+   int iBadAllowed;                                                    \
+                                                                       \
+   /* Allow log2 of the length badly unbalanced partitions. */         \
+   iBadAllowed = 0;                                                    \
+   for (uLength = (size_t)(ppvHi - ppvLo); uLength > 1; uLength /= 2)  \
+      iBadAllowed++;                                                   \
+   if (iBadAllowed > 0)                                                \
+      Name##_pdqsort(ppvLo, ppvHi, iBadAllowed, 1, ctx);               \
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Generate
+      void Name_sortRange(DynArray_T oDynArray, size_t uIndex,
+                          size_t uCount);
+      void Name_sort(DynArray_T oDynArray);
+   which do what DynArray_sortRange and DynArray_sort do, in the order
+   determined by int pfCompare(Type tElement1, Type tElement2). */
+
+#define DYNARRAY_DEFINE_SORT(Name, Type, pfCompare)                    \
+                                                                       \
+static int Name##_compareWith(int iUnused, void *pvElement1,           \
+                              void *pvElement2)                        \
+{                                                                      \
+   (void)iUnused;                                                      \
+   return pfCompare((Type)pvElement1, (Type)pvElement2);               \
+}                                                                      \
+                                                                       \
+DYNARRAY_DEFINE_SORT_WITH(Name, int, Name##_compareWith)               \
+                                                                       \
+static TYPEDARRAY_UNUSED void Name##_sortRange(DynArray_T oDynArray,   \
+                                               size_t uIndex,          \
+                                               size_t uCount)          \
+{                                                                      \
+   void **ppvArray;                                                    \
+                                                                       \
+   if (uCount < 2)                                                     \
+      return;                                                          \
+   ppvArray = DynArray_getArray(oDynArray);                            \
+   Name##_sortElements(&ppvArray[uIndex], &ppvArray[uIndex + uCount],  \
+                       0);                                             \
+}                                                                      \
+                                                                       \
+static TYPEDARRAY_UNUSED void Name##_sort(DynArray_T oDynArray)        \
+{                                                                      \
+   Name##_sortRange(oDynArray, 0, DynArray_getLength(oDynArray));      \
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Generate
+      int Name_bsearch(DynArray_T oDynArray, const KeyType *pkKey,
+                       size_t *puIndex);
+   which does what DynArray_bsearch does, with
+   int pfCompareKey(Type tElement, const KeyType *pkKey) comparing an
+   element with the sought key, so that the key need not be an
+   element.  It calls pfCompareKey directly unless the array is
+   searched through its shadow index, which DynArray_bsearch does. */
+
+#define DYNARRAY_DEFINE_BSEARCH(Name, Type, KeyType, pfCompareKey)     \
+                                                                       \
+static int Name##_compareKeyElement(const void *pvElement,             \
+                                    const void *pvKey)                 \
+{                                                                      \
+   return pfCompareKey((Type)pvElement, (const KeyType*)pvKey);        \
+}                                                                      \
+                                                                       \
+static TYPEDARRAY_UNUSED int Name##_bsearch(DynArray_T oDynArray,      \
+                                            const KeyType *pkKey,      \
+                                            size_t *puIndex)           \
+{                                                                      \
+   /* This is DynArray_bsearchHelp, with pfCompareKey called           \
+      directly. */                                                     \
+                                                                       \
+   void *const *ppvArray;                                              \
+   void *const *ppvBase;                                               \
+   size_t uLength;                                                     \
+   size_t uHalf;                                                       \
+   int iCompare;                                                       \
+                                                                       \
+   if (DynArray_isIndexed(oDynArray))                                  \
+      return DynArray_bsearch(oDynArray, (void*)pkKey, puIndex,        \
+                              Name##_compareKeyElement);               \
+                                                                       \
+   uLength = DynArray_getLength(oDynArray);                            \
+   if (uLength == 0)                                                   \
+   {                                                                   \
+      *puIndex = 0;                                                    \
+      return 0;                                                        \
+   }                                                                   \
+                                                                       \
+   ppvArray = DynArray_getElements(oDynArray);                         \
+   ppvBase = ppvArray;                                                 \
+   while (uLength > 1)                                                 \
+   {                                                                   \
+      uHalf = uLength / 2;                                             \
+      TYPEDARRAY_PREFETCH(ppvBase[uHalf / 2]);                         \
+      TYPEDARRAY_PREFETCH(ppvBase[uHalf + uHalf / 2]);                 \
+      TYPEDARRAY_PREFETCH(ppvBase + uHalf / 4);                        \
+      TYPEDARRAY_PREFETCH(ppvBase + uHalf / 2 + uHalf / 4);            \
+      TYPEDARRAY_PREFETCH(ppvBase + uHalf + uHalf / 4);                \
+      TYPEDARRAY_PREFETCH(ppvBase + uHalf + uHalf / 2 + uHalf / 4);    \
+      ppvBase = (pfCompareKey(ppvBase[uHalf], pkKey) <= 0) ?           \
+         ppvBase + uHalf : ppvBase;                                    \
+      uLength -= uHalf;                                                \
+   }                                                                   \
+                                                                       \
+   iCompare = pfCompareKey(*ppvBase, pkKey);                           \
+   *puIndex = (size_t)(ppvBase - ppvArray) + (iCompare < 0);           \
+   return iCompare == 0;                                               \
+}
+
+#endif
@@ -0,0 +1 @@
+../0shared/hashtable.c
\ No newline at end of file
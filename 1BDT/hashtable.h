@@ -0,0 +1 @@
+../0shared/hashtable.h
\ No newline at end of file
@@ -0,0 +1 @@
+../0shared/typedarray.h
\ No newline at end of file
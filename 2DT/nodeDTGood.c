@@ -38,17 +38,15 @@ static int Node_addChild(Node_T oNParent, Node_T oNChild,
 }
 
 /*
-  Compares the string representation of oNfirst with a string
-  pcSecond representing a node's path.
+  Compares the path of oNFirst with oPSecond, a node's path.
   Returns <0, 0, or >0 if oNFirst is "less than", "equal to", or
-  "greater than" pcSecond, respectively.
+  "greater than" oPSecond, respectively.
 */
-static int Node_compareString(const Node_T oNFirst,
-                                 const char *pcSecond) {
+static int Node_comparePath(const Node_T oNFirst, Path_T oPSecond) {
    assert(oNFirst != NULL);
-   assert(pcSecond != NULL);
+   assert(oPSecond != NULL);
 
-   return Path_compareString(oNFirst->oPPath, pcSecond);
+   return Path_comparePath(oNFirst->oPPath, oPSecond);
 }
 
 
@@ -209,8 +207,8 @@ boolean Node_hasChild(Node_T oNParent, Path_T oPPath,
 
    /* *pulChildID is the index into oNParent->oDChildren */
    return DynArray_bsearch(oNParent->oDChildren,
-            (char*) Path_getPathname(oPPath), pulChildID,
-            (int (*)(const void*,const void*)) Node_compareString);
+            (void*) oPPath, pulChildID,
+            (int (*)(const void*,const void*)) Node_comparePath);
 }
 
 size_t Node_getNumChildren(Node_T oNParent) {
@@ -7,21 +7,76 @@
 #include <assert.h>
 #include <string.h>
 #include "a4def.h"
+#include "arena.h"
 #include "dynarray.h"
+#include "typedarray.h"
+#include "hashtable.h"
+#include "btree.h"
 #include "fileNode.h"
 #include "dirNode.h"
+#include "nodeIndex.h"
+#include "nameTable.h"
 
-/* A file node in a DT */
+/* The number of children past which a list of a directory's children
+   gets a hash table over their names */
+static const size_t HASH_THRESHOLD = 64;
+
+/*
+  The lookup structures of a directory with a wide list of children.
+  A list with a table is only appended to, so it is put back in order
+  when something needs its order.
+*/
+struct wideLists
+{
+    /* the maps from names to sub dirs and to files, or NULL while
+       that list is at most HASH_THRESHOLD long */
+    HashTable_T subDirNames;
+    HashTable_T fileNames;
+    /* the number of children at the start of each list that are
+       known to be in sorted order */
+    size_t subDirsSorted;
+    size_t filesSorted;
+};
+
+/*
+  The children of one kind that a directory has: in an array, which is
+  kept in order while it is narrow and only appended to once it is
+  wide, or in a BTree keyed by their names, which puts each child in
+  order as it comes in or goes out in O(log n)
+*/
+struct childList
+{
+    /* the children in an array, or NULL if they are in tree */
+    DynArray_T array;
+    /* the children in a BTree, or NULL if they are in array */
+    BTree_T tree;
+};
+
+/* Whether new directories keep their children in BTrees */
+static boolean bBTreeLists = FALSE;
+
+/* A directory node in an FT */
 struct dirNode
 {
-    /* the object corresponding to the node's absolute path */
+    /* the node's own path component, i.e., the last one of its path:
+       the name table's copy of it, and its id there */
+    const char *name;
+    unsigned int nameId;
+    /* the object corresponding to the node's absolute path, which is
+       only built once Dir_getPath asks for it, or NULL until then */
     Path_T path;
     /* this node's parent */
     Dir_T parentDir;
     /* the object containing links to its sub dirs */
-    DynArray_T subDirs;
+    struct childList subDirs;
     /* the object containing links to its files */
-    DynArray_T files;
+    struct childList files;
+    /* the lookup structures for wide lists, or NULL if neither list
+       has ever been wider than HASH_THRESHOLD; lists in BTrees never
+       have them */
+    struct wideLists *wide;
+    /* the arena that this node, and all of the above, come from */
+    Arena_T arena;
 };
 
 /*
@@ -38,56 +93,26 @@ struct dirNode
 */
 int Dir_new(Path_T oPPath, Dir_T oNParent, Dir_T *poNResult)
 {
-    struct dirNode *psNew;
-    Path_T oPParentPath = NULL;
-    Path_T oPNewPath = NULL;
     size_t ulParentDepth;
-    size_t ulIndex;
-    int iStatus;
+    size_t ulIndex = 0;
 
     assert(oPPath != NULL);
+    assert(poNResult != NULL);
 
-    /* allocate space for a new node */
-    psNew = (struct dirNode *)calloc(1, sizeof(struct dirNode));
-    if (psNew == NULL)
-    {
-        *poNResult = NULL;
-        return MEMORY_ERROR;
-    }
-
-    /* set the new node's path */
-    iStatus = Path_dup(oPPath, &oPNewPath);
-    if (iStatus != SUCCESS)
-    {
-        free(psNew);
-        *poNResult = NULL;
-        return iStatus;
-    }
-    psNew->path = oPNewPath;
-
-    /* validate and set the new node's parent */
+    /* validate the new node's parent */
     if (oNParent != NULL)
     {
-        size_t ulSharedDepth;
-
-        oPParentPath = oNParent->path;
-        ulParentDepth = Path_getDepth(oPParentPath);
-        ulSharedDepth = Path_getSharedPrefixDepth(psNew->path,
-                                                  oPParentPath);
+        ulParentDepth = Dir_getDepth(oNParent);
         /* parent must be an ancestor of child */
-        if (ulSharedDepth < ulParentDepth)
+        if (!Dir_isPrefixOf(oNParent, oPPath))
         {
-            Path_free(psNew->path);
-            free(psNew);
             *poNResult = NULL;
             return CONFLICTING_PATH;
         }
 
         /* parent must be exactly one level up from child */
-        if (Path_getDepth(psNew->path) != ulParentDepth + 1)
+        if (Path_getDepth(oPPath) != ulParentDepth + 1)
         {
-            Path_free(psNew->path);
-            free(psNew);
             *poNResult = NULL;
             return NO_SUCH_PATH;
         }
@@ -95,8 +120,6 @@ int Dir_new(Path_T oPPath, Dir_T oNParent, Dir_T *poNResult)
         /* parent must not already have child with this path */
         if (Dir_hasSubDir(oNParent, oPPath, &ulIndex))
         {
-            Path_free(psNew->path);
-            free(psNew);
             *poNResult = NULL;
             return ALREADY_IN_TREE;
         }
@@ -105,51 +128,559 @@ int Dir_new(Path_T oPPath, Dir_T oNParent, Dir_T *poNResult)
     {
         /* new node must be root */
         /* can only create one "level" at a time */
-        if (Path_getDepth(psNew->path) != 1)
+        if (Path_getDepth(oPPath) != 1)
         {
-            Path_free(psNew->path);
-            free(psNew);
             *poNResult = NULL;
             return NO_SUCH_PATH;
         }
     }
-    psNew->parentDir = oNParent;
 
-    /* initialize the new node */
-    psNew->subDirs = DynArray_new(0);
-    psNew->files = DynArray_new(0);
-    if (psNew->subDirs == NULL || psNew->files == NULL)
+    return Dir_newAt(oPPath, oNParent, ulIndex, poNResult);
+}
+
+void Dir_setBTreeLists(boolean bEnable)
+{
+    bBTreeLists = bEnable;
+}
+
+/*
+  Makes sure that oNParent has its lookup structures for wide lists.
+  Returns SUCCESS, or MEMORY_ERROR if memory could not be allocated.
+*/
+static int Dir_ensureWide(Dir_T oNParent)
+{
+    assert(oNParent != NULL);
+
+    if (oNParent->wide != NULL)
+        return SUCCESS;
+    oNParent->wide = Arena_alloc(oNParent->arena, sizeof(struct wideLists));
+    if (oNParent->wide == NULL)
+        return MEMORY_ERROR;
+    /* narrow lists are kept in order */
+    oNParent->wide->subDirsSorted =
+        DynArray_getLength(oNParent->subDirs.array);
+    oNParent->wide->filesSorted = DynArray_getLength(oNParent->files.array);
+    return SUCCESS;
+}
+
+/* Frees oNNode's lookup structures for wide lists, if it has them. */
+static void Dir_freeWide(Dir_T oNNode)
+{
+    assert(oNNode != NULL);
+
+    if (oNNode->wide == NULL)
+        return;
+    if (oNNode->wide->subDirNames != NULL)
+        HashTable_free(oNNode->wide->subDirNames);
+    if (oNNode->wide->fileNames != NULL)
+        HashTable_free(oNNode->wide->fileNames);
+    Arena_release(oNNode->arena, oNNode->wide, sizeof(struct wideLists));
+    oNNode->wide = NULL;
+}
+
+/* Compares oNDir's name with psKey, for bsearch over sub dirs. */
+static int Dir_compareSubDirKey(const Dir_T oNDir,
+                                const struct nameKey *psKey)
+{
+    return NameTable_compareKey(oNDir->name, oNDir->nameId, psKey);
+}
+
+int Dir_compare(Dir_T oNFirst, Dir_T oNSecond)
+{
+    assert(oNFirst != NULL);
+    assert(oNSecond != NULL);
+
+    /* equal names have equal ids */
+    if (oNFirst->nameId == oNSecond->nameId)
+        return 0;
+    return strcmp(oNFirst->name, oNSecond->name);
+}
+
+/* A directory's sub dirs and files, with Dir_compare and
+   Dir_compareSubDirKey called directly; the files are sorted and
+   searched by fileNode.c, which can call File_compare directly */
+DYNARRAY_DEFINE_TYPE(SubDirArray, Dir_T)
+DYNARRAY_DEFINE_SORT(SubDirArray, Dir_T, Dir_compare)
+DYNARRAY_DEFINE_BSEARCH(SubDirArray, Dir_T, struct nameKey,
+                        Dir_compareSubDirKey)
+DYNARRAY_DEFINE_TYPE(FileArray, File_T)
+
+/* Sets *psKey to the name of sub dir pvChild. */
+static void Dir_getSubDirKey(const void *pvChild, struct nameKey *psKey)
+{
+    const struct dirNode *psDir = pvChild;
+
+    NameTable_getKey(psDir->nameId, psKey);
+}
+
+/* Sets *psKey to the name of file pvChild. */
+static void Dir_getFileKey(const void *pvChild, struct nameKey *psKey)
+{
+    NameTable_getKey(File_getNameId((File_T)pvChild), psKey);
+}
+
+/* How to handle the children in one kind of list */
+struct listKind
+{
+    /* gives a child's name */
+    void (*pfGetKey)(const void *pvChild, struct nameKey *psKey);
+    /* binary searches a sorted list for a name, as DynArray_bsearch
+       does */
+    int (*pfSearch)(DynArray_T oDList, const struct nameKey *psKey,
+                    size_t *pulIndex);
+    /* sorts a range of a list, as DynArray_sortRange does */
+    void (*pfSortRange)(DynArray_T oDList, size_t ulIndex,
+                        size_t ulCount);
+    /* compares two children, for merging */
+    int (*pfCompare)(const void *pvChild1, const void *pvChild2);
+};
+
+static const struct listKind sSubDirKind = {
+    Dir_getSubDirKey,
+    SubDirArray_bsearch,
+    SubDirArray_sortRange,
+    (int (*)(const void *, const void *))Dir_compare};
+
+static const struct listKind sFileKind = {
+    Dir_getFileKey,
+    File_bsearchArray,
+    File_sortArray,
+    (int (*)(const void *, const void *))File_compare};
+
+/*
+  Sets psList up as an empty list from oArena, in a BTree if bTree.
+  Returns SUCCESS, or MEMORY_ERROR if memory could not be allocated.
+*/
+static int Dir_initList(Arena_T oArena, struct childList *psList,
+                        boolean bTree)
+{
+    assert(psList != NULL);
+
+    psList->array = NULL;
+    psList->tree = NULL;
+    if (bTree)
+        psList->tree = BTree_newIn(oArena);
+    else
+        psList->array = DynArray_newIn(oArena, 0);
+    if (psList->array == NULL && psList->tree == NULL)
+        return MEMORY_ERROR;
+    return SUCCESS;
+}
+
+/* Frees psList, but not its children. */
+static void Dir_freeList(struct childList *psList)
+{
+    assert(psList != NULL);
+
+    if (psList->tree != NULL)
+        BTree_free(psList->tree);
+    if (psList->array != NULL)
+        DynArray_free(psList->array);
+}
+
+/* Returns the number of children in psList. */
+static size_t Dir_listLength(const struct childList *psList)
+{
+    assert(psList != NULL);
+
+    if (psList->tree != NULL)
+        return BTree_getLength(psList->tree);
+    return DynArray_getLength(psList->array);
+}
+
+/* Returns the sub dir of oNParent at index ulIndex. */
+static Dir_T Dir_subDirAt(Dir_T oNParent, size_t ulIndex)
+{
+    if (oNParent->subDirs.tree != NULL)
+        return BTree_getAt(oNParent->subDirs.tree, ulIndex);
+    return SubDirArray_get(oNParent->subDirs.array, ulIndex);
+}
+
+/* Returns the file of oNParent at index ulIndex. */
+static File_T Dir_fileAt(Dir_T oNParent, size_t ulIndex)
+{
+    if (oNParent->files.tree != NULL)
+        return BTree_getAt(oNParent->files.tree, ulIndex);
+    return FileArray_get(oNParent->files.array, ulIndex);
+}
+
+/*
+  Returns a new table, from oArena, that maps the name of every child
+  in oDList, a list of psKind's kind, to the child, or NULL if memory
+  could not be allocated. The names' hashes are the ones cached in the
+  children, so no name is read.
+*/
+static HashTable_T Dir_hashList(Arena_T oArena, DynArray_T oDList,
+                                const struct listKind *psKind)
+{
+    HashTable_T oHNames;
+    size_t ulIndex;
+    void *pvChild;
+    struct nameKey sKey;
+
+    assert(oDList != NULL);
+    assert(psKind != NULL);
+
+    oHNames = HashTable_newIn(oArena, 2 * DynArray_getLength(oDList));
+    if (oHNames == NULL)
+        return NULL;
+    for (ulIndex = 0; ulIndex < DynArray_getLength(oDList); ulIndex++)
+    {
+        pvChild = DynArray_get(oDList, ulIndex);
+        (*psKind->pfGetKey)(pvChild, &sKey);
+        if (!HashTable_putHashed(oHNames, sKey.pcName, sKey.ulLength,
+                                 sKey.uHash, pvChild))
+        {
+            HashTable_free(oHNames);
+            return NULL;
+        }
+    }
+    return oHNames;
+}
+
+/*
+  Puts the list oDList of oNParent's children, whose first *pulSorted
+  children are in order and whose kind is psKind, in order. Only the
+  children after those are sorted, and are then merged into them in
+  one pass, so a wide list that has grown since it was last in order
+  is not sorted all over again.
+*/
+static void Dir_sortList(Dir_T oNParent, DynArray_T oDList,
+                         size_t *pulSorted, const struct listKind *psKind)
+{
+    size_t ulLength;
+    size_t ulNew;
+    void **ppvNew;
+
+    assert(oNParent != NULL);
+    assert(oDList != NULL);
+    assert(pulSorted != NULL);
+    assert(psKind != NULL);
+
+    ulLength = DynArray_getLength(oDList);
+    if (*pulSorted == ulLength)
+        return;
+
+    ulNew = ulLength - *pulSorted;
+    (*psKind->pfSortRange)(oDList, *pulSorted, ulNew);
+    /* new children that all follow the old ones need no merge */
+    if (*pulSorted > 0 &&
+        (*psKind->pfCompare)(DynArray_get(oDList, *pulSorted - 1),
+                             DynArray_get(oDList, *pulSorted)) > 0)
+    {
+        ppvNew = Arena_alloc(oNParent->arena, ulNew * sizeof(void *));
+        if (ppvNew == NULL)
+            /* without room to merge, sort the whole list */
+            (*psKind->pfSortRange)(oDList, 0, ulLength);
+        else
+        {
+            /* the list has room for the new children it just gave up,
+               so the merge cannot fail */
+            DynArray_removeRange(oDList, *pulSorted, ulNew, ppvNew);
+            (void)DynArray_mergeSorted(oDList, ppvNew, ulNew,
+                                       psKind->pfCompare);
+            Arena_release(oNParent->arena, ppvNew, ulNew * sizeof(void *));
+        }
+    }
+    *pulSorted = ulLength;
+}
+
+/*
+  Links pvChild into the list psList of oNParent's children, as
+  Dir_addSubDir and Dir_addFile describe, where *poHNames and
+  *pulSorted are the list's table and sorted length (and are NULL if
+  oNParent has no lookup structures yet) and psKind is the list's kind.
+  Returns SUCCESS or MEMORY_ERROR.
+*/
+static int Dir_addToList(Dir_T oNParent, struct childList *psList,
+                         HashTable_T *poHNames, size_t *pulSorted,
+                         const struct listKind *psKind, void *pvChild,
+                         size_t ulIndex)
+{
+    DynArray_T oDList = psList->array;
+    size_t ulLength;
+    struct nameKey sKey;
+
+    assert(oNParent != NULL);
+    assert(psKind != NULL);
+    assert(pvChild != NULL);
+
+    /* a tree finds the child's place by its name, which is the name
+       table's copy and so lives as long as the child */
+    if (psList->tree != NULL)
+    {
+        (*psKind->pfGetKey)(pvChild, &sKey);
+        if (!BTree_put(psList->tree, sKey.pcName, pvChild))
+            return MEMORY_ERROR;
+        return SUCCESS;
+    }
+
+    /* a wide list only grows at its end */
+    if (poHNames != NULL && *poHNames != NULL)
+    {
+        (*psKind->pfGetKey)(pvChild, &sKey);
+        ulLength = DynArray_getLength(oDList);
+        if (!HashTable_putHashed(*poHNames, sKey.pcName, sKey.ulLength,
+                                 sKey.uHash, pvChild))
+            return MEMORY_ERROR;
+        if (!DynArray_add(oDList, pvChild))
+        {
+            (void)HashTable_removeHashed(*poHNames, sKey.pcName,
+                                         sKey.ulLength, sKey.uHash);
+            return MEMORY_ERROR;
+        }
+        /* the list stays in order if the child follows the rest */
+        if (*pulSorted == ulLength &&
+            (ulLength == 0 ||
+             (*psKind->pfCompare)(DynArray_get(oDList, ulLength - 1),
+                                  pvChild) < 0))
+            (*pulSorted)++;
+        return SUCCESS;
+    }
+
+    if (!DynArray_addAt(oDList, ulIndex, pvChild))
+        return MEMORY_ERROR;
+
+    /* a narrow list only needs a table once it is wide; without one,
+       lookups just fall back to binary search */
+    if (DynArray_getLength(oDList) > HASH_THRESHOLD &&
+        Dir_ensureWide(oNParent) == SUCCESS)
+    {
+        if (psList == &oNParent->subDirs)
+            oNParent->wide->subDirNames =
+                Dir_hashList(oNParent->arena, oDList, psKind);
+        else
+            oNParent->wide->fileNames =
+                Dir_hashList(oNParent->arena, oDList, psKind);
+    }
+    return SUCCESS;
+}
+
+/*
+  Removes pvChild from the list psList of oNParent's children, whose
+  table is oHNames (or NULL), whose sorted length is *pulSorted (or
+  NULL), and whose kind is psKind.
+*/
+static void Dir_removeFromList(Dir_T oNParent, struct childList *psList,
+                               HashTable_T oHNames, size_t *pulSorted,
+                               const struct listKind *psKind,
+                               void *pvChild)
+{
+    DynArray_T oDList = psList->array;
+    size_t ulIndex;
+    struct nameKey sKey;
+
+    assert(oNParent != NULL);
+    assert(psKind != NULL);
+    assert(pvChild != NULL);
+
+    (*psKind->pfGetKey)(pvChild, &sKey);
+    if (psList->tree != NULL)
+    {
+        (void)BTree_remove(psList->tree, sKey.pcName);
+        return;
+    }
+    if (oHNames != NULL)
+        (void)HashTable_removeHashed(oHNames, sKey.pcName, sKey.ulLength,
+                                     sKey.uHash);
+    if (pulSorted != NULL)
+        Dir_sortList(oNParent, oDList, pulSorted, psKind);
+    if ((*psKind->pfSearch)(oDList, &sKey, &ulIndex))
+    {
+        (void)DynArray_removeAt(oDList, ulIndex);
+        if (pulSorted != NULL)
+            (*pulSorted)--;
+    }
+}
+
+/*
+  Returns the child in the list psList, whose table is oHNames (or
+  NULL) and whose kind is psKind, that has the name psKey, or NULL if
+  there is none. Sets *pulChildID as Dir_lookupSubDir does.
+*/
+static void *Dir_findInList(const struct childList *psList,
+                            HashTable_T oHNames,
+                            const struct listKind *psKind,
+                            const struct nameKey *psKey,
+                            size_t *pulChildID)
+{
+    DynArray_T oDList = psList->array;
+
+    assert(psKind != NULL);
+    assert(psKey != NULL);
+    assert(pulChildID != NULL);
+
+    /* a tree is always in order, so its index is the child's */
+    if (psList->tree != NULL)
+    {
+        if (!BTree_searchChars(psList->tree, psKey->pcName,
+                               psKey->ulLength, pulChildID))
+            return NULL;
+        return BTree_getAt(psList->tree, *pulChildID);
+    }
+
+    if (oHNames != NULL)
+    {
+        /* new children go at the end of a wide list */
+        *pulChildID = DynArray_getLength(oDList);
+        return HashTable_getHashed(oHNames, psKey->pcName, psKey->ulLength,
+                                   psKey->uHash);
+    }
+    if (!(*psKind->pfSearch)(oDList, psKey, pulChildID))
+        return NULL;
+    return DynArray_get(oDList, *pulChildID);
+}
+
+/*
+  Checks if the list psList of oNParent's children, whose table is
+  oHNames (or NULL) and whose kind is psKind, has a child with the name
+  psKey, setting *pulChildID as Dir_hasSubDir does.
+*/
+static boolean Dir_hasInList(Dir_T oNParent, const struct childList *psList,
+                             HashTable_T oHNames,
+                             const struct listKind *psKind,
+                             const struct nameKey *psKey,
+                             size_t *pulChildID)
+{
+    if (Dir_findInList(psList, oHNames, psKind, psKey, pulChildID) == NULL)
+        return FALSE;
+    if (oHNames == NULL)
+        return TRUE;
+    /* the hash table answers misses, but a hit's index needs order */
+    Dir_sortChildren(oNParent);
+    return (boolean)(*psKind->pfSearch)(psList->array, psKey, pulChildID);
+}
+
+/*
+  Creates a new dir node from oArena like Dir_newAt. A node's
+  descendants all come from the same arena as the node itself.
+*/
+static int Dir_create(Arena_T oArena, Path_T oPPath, Dir_T oNParent,
+                      size_t ulIndex, boolean bAdopt, Dir_T *poNResult)
+{
+    struct dirNode *psNew;
+    size_t ulLevel;
+    struct nameKey sKey;
+    int iStatus;
+
+    assert(oPPath != NULL);
+    assert(poNResult != NULL);
+    assert(oNParent != NULL || Path_getDepth(oPPath) == 1);
+    assert(oNParent == NULL ||
+           ulIndex <= Dir_listLength(&oNParent->subDirs));
+
+    /* allocate space for a new node */
+    psNew = (struct dirNode *)Arena_alloc(oArena, sizeof(struct dirNode));
+    if (psNew == NULL)
     {
-        Path_free(psNew->path);
-        free(psNew);
         *poNResult = NULL;
         return MEMORY_ERROR;
     }
+    psNew->arena = oArena;
 
-    /* Link into parent's children list */
-    if (oNParent != NULL)
+    /* set the new node's name: its parent already holds the rest */
+    ulLevel = Path_getDepth(oPPath) - 1;
+    NameTable_makeKey(&sKey, Path_getComponent(oPPath, ulLevel),
+                      Path_getComponentLength(oPPath, ulLevel),
+                      Path_getComponentHash(oPPath, ulLevel));
+    if (NameTable_intern(&sKey, &psNew->nameId) != SUCCESS)
+    {
+        Arena_release(oArena, psNew, sizeof(struct dirNode));
+        *poNResult = NULL;
+        return MEMORY_ERROR;
+    }
+    psNew->name = NameTable_getString(psNew->nameId);
+    psNew->path = bAdopt ? oPPath : NULL;
+    psNew->parentDir = oNParent;
+
+    /* initialize the new node: Arena_alloc left both lists NULL */
+    iStatus = Dir_initList(oArena, &psNew->subDirs, bBTreeLists);
+    if (iStatus == SUCCESS)
+        iStatus = Dir_initList(oArena, &psNew->files, bBTreeLists);
+    if (iStatus == SUCCESS)
     {
-        iStatus = Dir_addSubDir(oNParent, psNew, ulIndex);
-        if (iStatus != SUCCESS)
+        iStatus = SUCCESS;
+        /* Link into parent's children list */
+        if (oNParent != NULL)
+            iStatus = Dir_addSubDir(oNParent, psNew, ulIndex);
+        /* and into the tree-wide index */
+        if (iStatus == SUCCESS)
         {
-            Path_free(psNew->path);
-            free(psNew);
-            *poNResult = NULL;
-            return iStatus;
+            iStatus = NodeIndex_addDir(psNew);
+            if (iStatus != SUCCESS && oNParent != NULL)
+                Dir_unlinkSubDir(oNParent, psNew);
         }
     }
+    if (iStatus != SUCCESS)
+    {
+        Dir_freeList(&psNew->subDirs);
+        Dir_freeList(&psNew->files);
+        /* an adopted path is still the caller's */
+        if (!bAdopt)
+            Path_free(psNew->path);
+        NameTable_release(psNew->nameId);
+        Arena_release(oArena, psNew, sizeof(struct dirNode));
+        *poNResult = NULL;
+        return iStatus;
+    }
 
     *poNResult = psNew;
-
     return SUCCESS;
 }
-int Dir_compare(Dir_T oNFirst, Dir_T oNSecond)
+
+int Dir_newAt(Path_T oPPath, Dir_T oNParent, size_t ulIndex,
+              Dir_T *poNResult)
 {
-    assert(oNFirst != NULL);
-    assert(oNSecond != NULL);
+    return Dir_create(oNParent != NULL ? oNParent->arena : NULL, oPPath,
+                      oNParent, ulIndex, FALSE, poNResult);
+}
+
+int Dir_newIn(Arena_T oArena, Path_T oPPath, Dir_T *poNResult)
+{
+    return Dir_create(oArena, oPPath, NULL, 0, FALSE, poNResult);
+}
 
-    return Path_comparePath(oNFirst->path, oNSecond->path);
+int Dir_adoptAt(Path_T oPPath, Dir_T oNParent, size_t ulIndex,
+                Dir_T *poNResult)
+{
+    return Dir_create(oNParent != NULL ? oNParent->arena : NULL, oPPath,
+                      oNParent, ulIndex, TRUE, poNResult);
 }
+
+int Dir_adoptIn(Arena_T oArena, Path_T oPPath, Dir_T *poNResult)
+{
+    return Dir_create(oArena, oPPath, NULL, 0, TRUE, poNResult);
+}
+
+/*
+  Frees what oNNode owns once the walk has left it: its lists, its
+  path and the nodes of its sub dirs, whose own subtrees are already
+  gone. oNNode's node and name stay until its parent is left in turn,
+  since the walk may still compare names among oNNode's siblings.
+*/
+static void Dir_freeContents(Dir_T oNNode)
+{
+    size_t ulIndex;
+    Dir_T oNChild;
+
+    assert(oNNode != NULL);
+
+    for (ulIndex = 0; ulIndex < Dir_listLength(&oNNode->subDirs);
+         ulIndex++)
+    {
+        oNChild = Dir_subDirAt(oNNode, ulIndex);
+        NameTable_release(oNChild->nameId);
+        Arena_release(oNChild->arena, oNChild, sizeof(struct dirNode));
+    }
+    Dir_freeList(&oNNode->files);
+    Dir_freeList(&oNNode->subDirs);
+    Dir_freeWide(oNNode);
+
+    /* remove path, once nothing refers to it */
+    NodeIndex_removeDir(oNNode);
+    Path_free(oNNode->path);
+}
+
 /*
   Destroys and frees all memory allocated for the subtree rooted at
   oNNode, i.e., deletes this node and all its descendents. Returns the
@@ -157,42 +688,107 @@ int Dir_compare(Dir_T oNFirst, Dir_T oNSecond)
 */
 size_t Dir_free(Dir_T oNNode)
 {
-    size_t ulIndex;
     size_t ulCount = 0;
+    struct dirIter sIter;
+    int iStep;
+    Dir_T oNDir;
+    File_T oNFile;
 
     assert(oNNode != NULL);
 
-    /* remove from parent's list */
+    /* remove from parent's list: the only unlinking to do */
     if (oNNode->parentDir != NULL)
+        Dir_unlinkSubDir(oNNode->parentDir, oNNode);
+
+    /* the walk unlinks nothing else: the whole subtree goes, so its
+       nodes' lists are dropped as they are, and never sorted first */
+    DirIter_beginUnordered(&sIter, oNNode);
+    for (;;)
     {
-        if (DynArray_bsearch(
-                oNNode->parentDir->subDirs,
-                oNNode, &ulIndex,
-                (int (*)(const void *, const void *))Dir_compare))
-            (void)DynArray_removeAt(oNNode->parentDir->subDirs,
-                                    ulIndex);
+        iStep = DirIter_next(&sIter, &oNDir, &oNFile);
+        if (iStep == DIR_ITER_END)
+            break;
+        if (iStep == DIR_ITER_FILE)
+        {
+            File_destroy(oNFile);
+            ulCount++;
+        }
+        else if (iStep == DIR_ITER_LEAVE)
+        {
+            Dir_freeContents(oNDir);
+            ulCount++;
+        }
     }
-    /* remove all files */
-    while (DynArray_getLength(oNNode->files) != 0)
+    DirIter_end(&sIter);
+
+    /* finally, free the struct node */
+    NameTable_release(oNNode->nameId);
+    Arena_release(oNNode->arena, oNNode, sizeof(struct dirNode));
+    return ulCount;
+}
+
+/* Where Dir_buildPath is in the path it builds from its end */
+struct pathBuild
+{
+    /* the name of the node whose path it is, until it is used */
+    const char *pcName;
+    /* the directory whose name comes next, once pcName is used */
+    Dir_T oNNext;
+};
+
+/*
+  Gives the next name back towards the root of the path psBuild is
+  building, in *ppcName and *pulNameLength, for Path_build.
+*/
+static void Dir_getPrevName(void *pvBuild, const char **ppcName,
+                            size_t *pulNameLength)
+{
+    struct pathBuild *psBuild = pvBuild;
+    struct nameKey sName;
+
+    assert(psBuild != NULL);
+
+    if (psBuild->pcName != NULL)
     {
-        (void)File_free(DynArray_get(oNNode->files, 0));
-        ulCount++;
+        *ppcName = psBuild->pcName;
+        *pulNameLength = strlen(psBuild->pcName);
+        psBuild->pcName = NULL;
+        return;
     }
-    /* recursively remove subDirs */
-    while (DynArray_getLength(oNNode->subDirs) != 0)
+    assert(psBuild->oNNext != NULL);
+    NameTable_getKey(psBuild->oNNext->nameId, &sName);
+    *ppcName = sName.pcName;
+    *pulNameLength = sName.ulLength;
+    psBuild->oNNext = psBuild->oNNext->parentDir;
+}
+
+/*-------------------------------------------------------*/
+int Dir_buildPath(Arena_T oArena, Dir_T oNParent, const char *pcName,
+                  Path_T *poPResult)
+{
+    Dir_T oNCurr;
+    size_t ulDepth = 1;
+    size_t ulLength;
+    struct nameKey sName;
+    struct pathBuild sBuild;
+
+    assert(pcName != NULL);
+    assert(poPResult != NULL);
+
+    /* measure the path, so that Path_build can fill it in from its end
+       back to the root, straight into the path's own block */
+    ulLength = strlen(pcName);
+    for (oNCurr = oNParent; oNCurr != NULL; oNCurr = oNCurr->parentDir)
     {
-        ulCount += Dir_free(DynArray_get(oNNode->subDirs, 0));
+        NameTable_getKey(oNCurr->nameId, &sName);
+        ulLength += sName.ulLength + 1;
+        ulDepth++;
     }
-    DynArray_free(oNNode->files);
-    DynArray_free(oNNode->subDirs);
 
-    /* remove path */
-    Path_free(oNNode->path);
-
-    /* finally, free the struct node */
-    free(oNNode);
-    ulCount++;
-    return ulCount;
+    sBuild.pcName = pcName;
+    sBuild.oNNext = oNParent;
+    return Path_build(oArena, ulDepth, ulLength, Dir_getPrevName, &sBuild,
+                      poPResult);
 }
 
 /*-------------------------------------------------------*/
@@ -201,9 +797,66 @@ Path_T Dir_getPath(Dir_T oNNode)
 
     assert(oNNode != NULL);
 
+    if (oNNode->path == NULL)
+        (void)Dir_buildPath(oNNode->arena, oNNode->parentDir,
+                            oNNode->name, &oNNode->path);
     return oNNode->path;
 }
 
+/*-------------------------------------------------------*/
+Arena_T Dir_getArena(Dir_T oNNode)
+{
+    assert(oNNode != NULL);
+
+    return oNNode->arena;
+}
+
+/*-------------------------------------------------------*/
+const char *Dir_getName(Dir_T oNNode)
+{
+    assert(oNNode != NULL);
+
+    return oNNode->name;
+}
+
+/*-------------------------------------------------------*/
+size_t Dir_getDepth(Dir_T oNNode)
+{
+    size_t ulDepth = 0;
+
+    assert(oNNode != NULL);
+
+    for (; oNNode != NULL; oNNode = oNNode->parentDir)
+        ulDepth++;
+    return ulDepth;
+}
+
+/*-------------------------------------------------------*/
+boolean Dir_isPrefixOf(Dir_T oNNode, Path_T oPPath)
+{
+    size_t ulLevel;
+    struct nameKey sName;
+
+    assert(oNNode != NULL);
+    assert(oPPath != NULL);
+
+    ulLevel = Dir_getDepth(oNNode);
+    if (ulLevel > Path_getDepth(oPPath))
+        return FALSE;
+
+    /* compare names from oNNode up to the root */
+    for (; oNNode != NULL; oNNode = oNNode->parentDir)
+    {
+        ulLevel--;
+        NameTable_getKey(oNNode->nameId, &sName);
+        if (sName.ulLength != Path_getComponentLength(oPPath, ulLevel) ||
+            memcmp(sName.pcName, Path_getComponent(oPPath, ulLevel),
+                   sName.ulLength) != 0)
+            return FALSE;
+    }
+    return TRUE;
+}
+
 /*-------------------------------------------------------*/
 Dir_T Dir_getParent(Dir_T oNNode)
 {
@@ -217,7 +870,7 @@ size_t Dir_getNumSubDirs(Dir_T oNParent)
 {
     assert(oNParent != NULL);
 
-    return DynArray_getLength(oNParent->subDirs);
+    return Dir_listLength(&oNParent->subDirs);
 }
 
 /*-------------------------------------------------------*/
@@ -227,7 +880,7 @@ int Dir_getSubDir(Dir_T oNParent, size_t ulChildID,
     assert(oNParent != NULL);
     assert(poNResult != NULL);
 
-    /* ulChildID is the index into oNParent->oDChildren */
+    /* ulChildID is the index into oNParent->subDirs, in order */
     if (ulChildID >= Dir_getNumSubDirs(oNParent))
     {
         *poNResult = NULL;
@@ -235,7 +888,8 @@ int Dir_getSubDir(Dir_T oNParent, size_t ulChildID,
     }
     else
     {
-        *poNResult = DynArray_get(oNParent->subDirs, ulChildID);
+        Dir_sortChildren(oNParent);
+        *poNResult = Dir_subDirAt(oNParent, ulChildID);
         return SUCCESS;
     }
 }
@@ -245,7 +899,7 @@ size_t Dir_getNumFiles(Dir_T oNParent)
 {
     assert(oNParent != NULL);
 
-    return DynArray_getLength(oNParent->files);
+    return Dir_listLength(&oNParent->files);
 }
 
 /*-------------------------------------------------------*/
@@ -257,7 +911,7 @@ int Dir_getFile(Dir_T oNParent, size_t ulChildID,
     assert(oNParent != NULL);
     assert(poNResult != NULL);
 
-    /* ulChildID is the index into oNParent->oDChildren */
+    /* ulChildID is the index into oNParent->files, in order */
     if (ulChildID >= Dir_getNumFiles(oNParent))
     {
         *poNResult = NULL;
@@ -265,18 +919,24 @@ int Dir_getFile(Dir_T oNParent, size_t ulChildID,
     }
     else
     {
-        *poNResult = DynArray_get(oNParent->files, ulChildID);
+        Dir_sortChildren(oNParent);
+        *poNResult = Dir_fileAt(oNParent, ulChildID);
         return SUCCESS;
     }
 }
-static int Dir_compareString(const Dir_T oNFirst,
-                             const char *pcSecond)
+/*-------------------------------------------------------*/
+void Dir_sortChildren(Dir_T oNParent)
 {
-    assert(oNFirst != NULL);
-    assert(pcSecond != NULL);
+    assert(oNParent != NULL);
 
-    return Path_compareString(oNFirst->path, pcSecond);
+    if (oNParent->wide == NULL)
+        return;
+    Dir_sortList(oNParent, oNParent->subDirs.array,
+                 &oNParent->wide->subDirsSorted, &sSubDirKind);
+    Dir_sortList(oNParent, oNParent->files.array,
+                 &oNParent->wide->filesSorted, &sFileKind);
 }
+
 /*
   Links new Dir_T oNChild into oNParent's children array at index
   ulIndex. Returns SUCCESS if the new sub dir child was added successfully,
@@ -288,58 +948,308 @@ int Dir_addSubDir(Dir_T oNParent, Dir_T oNChild, size_t ulIndex)
     assert(oNParent != NULL);
     assert(oNChild != NULL);
 
-    if (DynArray_addAt(oNParent->subDirs, ulIndex, oNChild))
-        return SUCCESS;
-    else
-        return MEMORY_ERROR;
+    return Dir_addToList(
+        oNParent, &oNParent->subDirs,
+        oNParent->wide != NULL ? &oNParent->wide->subDirNames : NULL,
+        oNParent->wide != NULL ? &oNParent->wide->subDirsSorted : NULL,
+        &sSubDirKind, oNChild, ulIndex);
 }
 int Dir_addFile(Dir_T oNParent, File_T oNChild, size_t ulIndex)
 {
     assert(oNParent != NULL);
     assert(oNChild != NULL);
 
-    if (DynArray_addAt(oNParent->files, ulIndex, oNChild))
-        return SUCCESS;
-    else
-        return MEMORY_ERROR;
+    return Dir_addToList(
+        oNParent, &oNParent->files,
+        oNParent->wide != NULL ? &oNParent->wide->fileNames : NULL,
+        oNParent->wide != NULL ? &oNParent->wide->filesSorted : NULL,
+        &sFileKind, oNChild, ulIndex);
 }
 
-boolean Dir_hasFile(Dir_T oNParent, Path_T oPPath, size_t *pulChildID)
+/*-------------------------------------------------------*/
+void Dir_unlinkSubDir(Dir_T oNParent, Dir_T oNChild)
 {
+    assert(oNParent != NULL);
+    assert(oNChild != NULL);
 
-    boolean ret2;
+    Dir_removeFromList(
+        oNParent, &oNParent->subDirs,
+        oNParent->wide != NULL ? oNParent->wide->subDirNames : NULL,
+        oNParent->wide != NULL ? &oNParent->wide->subDirsSorted : NULL,
+        &sSubDirKind, oNChild);
+}
+
+/*-------------------------------------------------------*/
+void Dir_unlinkFile(Dir_T oNParent, File_T oNChild)
+{
+    assert(oNParent != NULL);
+    assert(oNChild != NULL);
+
+    Dir_removeFromList(
+        oNParent, &oNParent->files,
+        oNParent->wide != NULL ? oNParent->wide->fileNames : NULL,
+        oNParent->wide != NULL ? &oNParent->wide->filesSorted : NULL,
+        &sFileKind, oNChild);
+}
+
+/*
+  Sets *psKey to the final component of oPPath, whose length and hash
+  oPPath already knows.
+*/
+static void Dir_getPathKey(Path_T oPPath, struct nameKey *psKey)
+{
+    size_t ulLevel = Path_getDepth(oPPath) - 1;
+
+    NameTable_makeKey(psKey, Path_getComponent(oPPath, ulLevel),
+                      Path_getComponentLength(oPPath, ulLevel),
+                      Path_getComponentHash(oPPath, ulLevel));
+}
+
+boolean Dir_hasFile(Dir_T oNParent, Path_T oPPath, size_t *pulChildID)
+{
+    struct nameKey sKey;
 
     assert(oNParent != NULL);
     assert(oPPath != NULL);
     assert(pulChildID != NULL);
 
-    ret2 = DynArray_bsearch(oNParent->files,
-                            (char *)Path_getPathname(oPPath), pulChildID,
-                            (int (*)(const void *, const void *))File_compareString);
-    return (boolean)ret2;
+    Dir_getPathKey(oPPath, &sKey);
+    return Dir_hasInList(
+        oNParent, &oNParent->files,
+        oNParent->wide != NULL ? oNParent->wide->fileNames : NULL,
+        &sFileKind, &sKey, pulChildID);
 }
 
 DynArray_T Dir_getFiles(Dir_T oNParent)
 {
     assert(oNParent != NULL);
 
-    return oNParent->files;
+    Dir_sortChildren(oNParent);
+    return oNParent->files.array;
 }
 
 boolean Dir_hasSubDir(Dir_T oNParent, Path_T oPPath, size_t *pulChildID)
 {
+    struct nameKey sKey;
 
     assert(oNParent != NULL);
     assert(oPPath != NULL);
     assert(pulChildID != NULL);
 
-    /* *pulChildID is the index into oNParent->oDChildren */
-    if (DynArray_bsearch(oNParent->subDirs,
-                         (char *)Path_getPathname(oPPath), pulChildID,
-                         (int (*)(const void *, const void *))Dir_compareString) == 1)
+    /* *pulChildID is the index into oNParent->subDirs */
+    Dir_getPathKey(oPPath, &sKey);
+    return Dir_hasInList(
+        oNParent, &oNParent->subDirs,
+        oNParent->wide != NULL ? oNParent->wide->subDirNames : NULL,
+        &sSubDirKind, &sKey, pulChildID);
+}
+
+/*-------------------------------------------------------*/
+Dir_T Dir_lookupSubDir(Dir_T oNParent, const struct nameKey *psName,
+                       size_t *pulChildID)
+{
+    assert(oNParent != NULL);
+    assert(psName != NULL);
+    assert(pulChildID != NULL);
+
+    return Dir_findInList(
+        &oNParent->subDirs,
+        oNParent->wide != NULL ? oNParent->wide->subDirNames : NULL,
+        &sSubDirKind, psName, pulChildID);
+}
+
+/*-------------------------------------------------------*/
+File_T Dir_lookupFile(Dir_T oNParent, const struct nameKey *psName,
+                      size_t *pulChildID)
+{
+    assert(oNParent != NULL);
+    assert(psName != NULL);
+    assert(pulChildID != NULL);
+
+    return Dir_findInList(
+        &oNParent->files,
+        oNParent->wide != NULL ? oNParent->wide->fileNames : NULL,
+        &sFileKind, psName, pulChildID);
+}
+
+/*-------------------------------------------------------*/
+/*
+  Records ulNextSubDir, the index of the next sub dir to visit in the
+  directory at depth ulDepth of psIter's walk, if there is room for it
+  on the stack. Levels past the inline part of the stack go on the
+  heap; if that cannot grow, the index is left unsaved and found again
+  on the way back up.
+*/
+static void DirIter_save(struct dirIter *psIter, size_t ulDepth,
+                         size_t ulNextSubDir)
+{
+    size_t ulNewCap;
+    size_t *pulNew;
+
+    assert(psIter != NULL);
+
+    if (ulDepth < DIR_ITER_INLINE_DEPTH)
     {
-        return TRUE;
+        psIter->aulInline[ulDepth] = ulNextSubDir;
+        return;
     }
-    else
-        return FALSE;
-}
\ No newline at end of file
+    ulDepth -= DIR_ITER_INLINE_DEPTH;
+    /* keep the saved levels contiguous: once one goes unsaved, so do
+       the ones below it */
+    if (ulDepth != psIter->ulHeapUsed)
+        return;
+    if (ulDepth >= psIter->ulHeapCap)
+    {
+        ulNewCap = 2 * psIter->ulHeapCap;
+        if (ulNewCap == 0)
+            ulNewCap = DIR_ITER_INLINE_DEPTH;
+        pulNew = realloc(psIter->pulHeap, ulNewCap * sizeof(size_t));
+        if (pulNew == NULL)
+            return;
+        psIter->pulHeap = pulNew;
+        psIter->ulHeapCap = ulNewCap;
+    }
+    psIter->pulHeap[ulDepth] = ulNextSubDir;
+    psIter->ulHeapUsed = ulDepth + 1;
+}
+
+/*
+  Returns the index of the next sub dir to visit in oNParent, the
+  directory at depth ulDepth of psIter's walk, whose sub dir oNChild
+  the walk is leaving. If the index went unsaved, an ordered walk
+  searches for oNChild by name, and an unordered one, whose lists may
+  not be sorted, scans for it.
+*/
+static size_t DirIter_restore(struct dirIter *psIter, size_t ulDepth,
+                              Dir_T oNParent, Dir_T oNChild)
+{
+    size_t ulIndex = 0;
+    struct nameKey sName;
+
+    assert(psIter != NULL);
+
+    if (ulDepth < DIR_ITER_INLINE_DEPTH)
+        return psIter->aulInline[ulDepth];
+    if (ulDepth - DIR_ITER_INLINE_DEPTH < psIter->ulHeapUsed)
+    {
+        ulIndex = psIter->pulHeap[ulDepth - DIR_ITER_INLINE_DEPTH];
+        psIter->ulHeapUsed = ulDepth - DIR_ITER_INLINE_DEPTH;
+        return ulIndex;
+    }
+    /* a tree is in order even for an unordered walk */
+    if (!psIter->bOrdered && oNParent->subDirs.tree == NULL)
+    {
+        while (SubDirArray_get(oNParent->subDirs.array, ulIndex) != oNChild)
+            ulIndex++;
+        return ulIndex + 1;
+    }
+    NameTable_getKey(oNChild->nameId, &sName);
+    (void)Dir_hasInList(
+        oNParent, &oNParent->subDirs,
+        oNParent->wide != NULL ? oNParent->wide->subDirNames : NULL,
+        &sSubDirKind, &sName, &ulIndex);
+    return ulIndex + 1;
+}
+
+/*-------------------------------------------------------*/
+void DirIter_begin(struct dirIter *psIter, Dir_T oNRoot)
+{
+    assert(psIter != NULL);
+
+    psIter->oNRoot = oNRoot;
+    psIter->bOrdered = TRUE;
+    psIter->oNCurr = NULL;
+    psIter->ulDepth = 0;
+    psIter->ulNextFile = 0;
+    psIter->ulNextSubDir = 0;
+    psIter->pulHeap = NULL;
+    psIter->ulHeapCap = 0;
+    psIter->ulHeapUsed = 0;
+}
+
+/*-------------------------------------------------------*/
+void DirIter_beginUnordered(struct dirIter *psIter, Dir_T oNRoot)
+{
+    assert(psIter != NULL);
+
+    DirIter_begin(psIter, oNRoot);
+    psIter->bOrdered = FALSE;
+}
+
+/*-------------------------------------------------------*/
+int DirIter_next(struct dirIter *psIter, Dir_T *poNDir, File_T *poNFile)
+{
+    Dir_T oNCurr;
+
+    assert(psIter != NULL);
+    assert(poNDir != NULL);
+    assert(poNFile != NULL);
+
+    *poNFile = NULL;
+    oNCurr = psIter->oNCurr;
+
+    /* the first step enters the root, and the last one is past it */
+    if (oNCurr == NULL)
+    {
+        *poNDir = psIter->oNRoot;
+        if (*poNDir == NULL)
+            return DIR_ITER_END;
+        psIter->oNCurr = psIter->oNRoot;
+        if (psIter->bOrdered)
+            Dir_sortChildren(psIter->oNCurr);
+        return DIR_ITER_ENTER;
+    }
+
+    *poNDir = oNCurr;
+    if (psIter->ulNextFile < Dir_listLength(&oNCurr->files))
+    {
+        *poNFile = Dir_fileAt(oNCurr, psIter->ulNextFile++);
+        return DIR_ITER_FILE;
+    }
+
+    if (psIter->ulNextSubDir < Dir_listLength(&oNCurr->subDirs))
+    {
+        *poNDir = Dir_subDirAt(oNCurr, psIter->ulNextSubDir++);
+        DirIter_save(psIter, psIter->ulDepth, psIter->ulNextSubDir);
+        psIter->oNCurr = *poNDir;
+        psIter->ulDepth++;
+        psIter->ulNextFile = 0;
+        psIter->ulNextSubDir = 0;
+        if (psIter->bOrdered)
+            Dir_sortChildren(psIter->oNCurr);
+        return DIR_ITER_ENTER;
+    }
+
+    /* oNCurr is done: go back up, before the caller may free it */
+    if (psIter->ulDepth == 0)
+    {
+        psIter->oNCurr = NULL;
+        psIter->oNRoot = NULL;
+        return DIR_ITER_LEAVE;
+    }
+    psIter->ulDepth--;
+    psIter->oNCurr = oNCurr->parentDir;
+    psIter->ulNextFile = Dir_listLength(&psIter->oNCurr->files);
+    psIter->ulNextSubDir = DirIter_restore(psIter, psIter->ulDepth,
+                                           psIter->oNCurr, oNCurr);
+    return DIR_ITER_LEAVE;
+}
+
+/*-------------------------------------------------------*/
+void DirIter_skipChildren(struct dirIter *psIter)
+{
+    assert(psIter != NULL);
+    assert(psIter->oNCurr != NULL);
+
+    psIter->ulNextFile = Dir_listLength(&psIter->oNCurr->files);
+    psIter->ulNextSubDir = Dir_listLength(&psIter->oNCurr->subDirs);
+}
+
+/*-------------------------------------------------------*/
+void DirIter_end(struct dirIter *psIter)
+{
+    assert(psIter != NULL);
+
+    free(psIter->pulHeap);
+    psIter->pulHeap = NULL;
+}
@@ -11,7 +11,10 @@ typedef struct dirNode *Dir_T;
 
 #include <stddef.h>
 #include "a4def.h"
+#include "arena.h"
+#include "dynarray.h"
 #include "path.h"
+#include "nameTable.h"
 #include "fileNode.h"
 
 
@@ -30,6 +33,49 @@ typedef struct dirNode *Dir_T;
 */
 int Dir_new(Path_T oPPath, Dir_T oNParent, Dir_T *poNResult);
 
+/*
+  Sets whether the dir nodes made from now on keep their sub dirs and
+  files in BTrees keyed by name, rather than in DynArrays, which is
+  off to begin with. A BTree adds or removes a child anywhere in
+  O(log n), where a narrow DynArray moves the children after it and a
+  wide one is sorted again before a removal; in exchange, it finds a
+  child in O(log n) where a wide DynArray hashes its name. Nodes that
+  already exist keep the lists they have.
+*/
+void Dir_setBTreeLists(boolean bEnable);
+
+/*
+  Creates a new dir node like Dir_new, but trusts the caller that
+  oPPath is a new child of oNParent (or a depth 1 root if oNParent is
+  NULL) that belongs at index ulIndex among oNParent's sub dirs, so no
+  validation or search is repeated. The new node comes from the same
+  arena as oNParent, or from the heap if oNParent is NULL. Returns
+  SUCCESS and sets *poNResult to be the new node, or sets *poNResult
+  to NULL and returns MEMORY_ERROR if memory could not be allocated to
+  complete request.
+*/
+int Dir_newAt(Path_T oPPath, Dir_T oNParent, size_t ulIndex,
+              Dir_T *poNResult);
+
+/*
+  Creates a new root dir node with the depth 1 path oPPath like
+  Dir_newAt, but allocates it from oArena (NULL for the heap), which
+  all of its descendants will then share. Freeing oArena frees the
+  whole tree at once, without Dir_free.
+*/
+int Dir_newIn(Arena_T oArena, Path_T oPPath, Dir_T *poNResult);
+
+/*
+  Creates a new dir node like Dir_newAt (or Dir_newIn), but instead of
+  building a path of its own when one is asked for, the node takes
+  over the caller's reference to oPPath, which must live as long as
+  the node: Dir_free frees it. If creation fails, oPPath is still the
+  caller's.
+*/
+int Dir_adoptAt(Path_T oPPath, Dir_T oNParent, size_t ulIndex,
+                Dir_T *poNResult);
+int Dir_adoptIn(Arena_T oArena, Path_T oPPath, Dir_T *poNResult);
+
 /*
   Destroys and frees all memory allocated for the subtree rooted at
   oNNode, i.e., deletes this node and all its descendents. Returns the
@@ -37,8 +83,38 @@ int Dir_new(Path_T oPPath, Dir_T oNParent, Dir_T *poNResult);
 */
 size_t Dir_free(Dir_T oNNode);
 
-/* Returns the path object representing oNNode's absolute path. */
+/*
+  Returns the path object representing oNNode's absolute path. Nodes
+  store only their own name, so the path is rebuilt from the names up
+  to the root on first use and cached until oNNode is freed. Returns
+  NULL if memory could not be allocated to build it.
+*/
 Path_T Dir_getPath(Dir_T oNNode);
+
+/* Returns oNNode's own name, i.e., the final component of its path. */
+const char *Dir_getName(Dir_T oNNode);
+
+/* Returns the arena that oNNode comes from, or NULL for the heap. */
+Arena_T Dir_getArena(Dir_T oNNode);
+
+/* Returns the depth of oNNode's path, i.e., 1 for the root. */
+size_t Dir_getDepth(Dir_T oNNode);
+
+/*
+  Checks if oNNode's path is oPPath or a prefix of it, by comparing
+  names from oNNode up to the root. Allocates nothing.
+*/
+boolean Dir_isPrefixOf(Dir_T oNNode, Path_T oPPath);
+
+/*
+  Builds the path of a node named pcName whose parent is oNParent
+  (or of a root if oNParent is NULL), allocating it from oArena.
+  Returns SUCCESS and sets
+  *poPResult to the new path, or sets *poPResult to NULL and returns
+  MEMORY_ERROR if memory could not be allocated to complete request.
+*/
+int Dir_buildPath(Arena_T oArena, Dir_T oNParent, const char *pcName,
+                  Path_T *poPResult);
 /* Returns the number of children that oNParent has. */
 size_t Dir_getNumSubDirs(Dir_T oNParent);
 
@@ -97,10 +173,115 @@ int Dir_rmFile(Dir_T oNParent, size_t ulChildID,
 /*It checks if oNParent has a child file with the given path oPPath with size pulChildID, returns boolean*/
 boolean Dir_hasFile(Dir_T oNParent, Path_T oPPath, size_t *pulChildID);
 
-/*It gets the dynamic array of the files that are stored in the oNParent, returns DynArray_T */
+/*It gets the dynamic array of the files that are stored in the oNParent, returns DynArray_T, or NULL if they are in a BTree */
 DynArray_T Dir_getFiles(Dir_T oNParent);
 
 /*It checks if oNParent has a child directory with the given path oPPath with size pulChildID, returns boolean*/
 boolean Dir_hasSubDir(Dir_T oNParent, Path_T oPPath, size_t *pulChildID);
 
+/*
+  Returns oNParent's child directory whose final path component is
+  the name psName stands for, or NULL if it has none. Sets *pulChildID
+  to the index to pass to Dir_addSubDir for a new child of that name.
+  Once oNParent has more than a few dozen sub dirs, this is a hash
+  lookup that leaves their order alone, and *pulChildID is not the
+  child's index.
+*/
+Dir_T Dir_lookupSubDir(Dir_T oNParent, const struct nameKey *psName,
+                       size_t *pulChildID);
+
+/* Like Dir_lookupSubDir, but for oNParent's child files. */
+File_T Dir_lookupFile(Dir_T oNParent, const struct nameKey *psName,
+                      size_t *pulChildID);
+
+/* Removes oNChild from oNParent's list of sub dirs, if it is there. */
+void Dir_unlinkSubDir(Dir_T oNParent, Dir_T oNChild);
+
+/* Removes oNChild from oNParent's list of files, if it is there. */
+void Dir_unlinkFile(Dir_T oNParent, File_T oNChild);
+
+/*
+  Puts oNParent's children back in sorted order, if they were added
+  out of order since the last time. Every other function that gives a
+  child's index or walks the children in order does this itself.
+*/
+void Dir_sortChildren(Dir_T oNParent);
+
+/* The number of levels that a dirIter keeps on its own, before its
+   stack moves on to the heap */
+#define DIR_ITER_INLINE_DEPTH 32
+
+/* The kinds of steps of a dirIter walk */
+enum { DIR_ITER_END, DIR_ITER_ENTER, DIR_ITER_FILE, DIR_ITER_LEAVE };
+
+/*
+  A dirIter walks the subtree rooted at a dir node in the order of
+  FT_toString: each directory, then its files, then its sub dirs'
+  subtrees, using an explicit stack rather than recursion, so that no
+  depth of tree can overflow the call stack. Callers keep the struct
+  itself (e.g., on their stack), but must only touch it through the
+  DirIter_* functions, and must not move it during the walk.
+*/
+struct dirIter
+{
+    /* the root of the walk, or NULL once the walk is done */
+    Dir_T oNRoot;
+    /* TRUE if the walk visits each directory's children in order */
+    boolean bOrdered;
+    /* the directory whose children are visited next, or NULL if the
+       walk has not started */
+    Dir_T oNCurr;
+    /* oNCurr's depth below oNRoot */
+    size_t ulDepth;
+    /* the indices of oNCurr's next file and next sub dir */
+    size_t ulNextFile;
+    size_t ulNextSubDir;
+    /* the next sub dir indices of oNCurr's ancestors, by depth: the
+       first levels inline, the rest in a heap array that holds
+       ulHeapUsed of ulHeapCap entries */
+    size_t aulInline[DIR_ITER_INLINE_DEPTH];
+    size_t *pulHeap;
+    size_t ulHeapCap;
+    size_t ulHeapUsed;
+};
+
+/*
+  Starts *psIter on a walk of the subtree rooted at oNRoot, which
+  may be NULL for an empty walk.
+*/
+void DirIter_begin(struct dirIter *psIter, Dir_T oNRoot);
+
+/*
+  Starts *psIter on a walk like DirIter_begin, but one that visits
+  each directory's children in whatever order they are stored, so
+  that it never sorts a list. For walks that do not care about order,
+  e.g., freeing or indexing a subtree.
+*/
+void DirIter_beginUnordered(struct dirIter *psIter, Dir_T oNRoot);
+
+/*
+  Takes the next step of *psIter's walk and returns what it was:
+  * DIR_ITER_ENTER for a directory, set in *poNDir, before its children
+  * DIR_ITER_FILE for a file, set in *poNFile, with its parent in *poNDir
+  * DIR_ITER_LEAVE for a directory, set in *poNDir, after its children;
+    the walk never touches it again, but its name must stay valid
+    until its parent is left in turn
+  * DIR_ITER_END when the walk is over
+  Never allocates per node: the stack grows with the depth, and if it
+  cannot, the walk finds its way back up by searching instead.
+  The subtree must not change during the walk, except that files and
+  directories that have been visited may be freed as described above.
+*/
+int DirIter_next(struct dirIter *psIter, Dir_T *poNDir, File_T *poNFile);
+
+/*
+  Skips the remaining files and sub dirs of the directory whose
+  children *psIter is visiting, e.g., the one it just entered, so that
+  the next step leaves it.
+*/
+void DirIter_skipChildren(struct dirIter *psIter);
+
+/* Frees what *psIter allocated for its stack. */
+void DirIter_end(struct dirIter *psIter);
+
 #endif
\ No newline at end of file
@@ -7,15 +7,24 @@
 #include <assert.h>
 #include <string.h>
 #include "a4def.h"
+#include "arena.h"
 #include "dynarray.h"
+#include "typedarray.h"
 #include "dirNode.h"
 #include "fileNode.h"
 #include "path.h"
+#include "nodeIndex.h"
+#include "nameTable.h"
 
-/* A file node in a DT */
+/* A file node in an FT */
 struct fileNode
 {
-   /* the object corresponding to the node's absolute path */
+   /* the node's own path component, i.e., the last one of its path:
+      the name table's copy of it, and its id there */
+   const char *name;
+   unsigned int nameId;
+   /* the object corresponding to the node's absolute path, which is
+      only built once File_getPath asks for it, or NULL until then */
    Path_T path;
    /* this node's parent */
    Dir_T parentDir;
@@ -30,14 +39,36 @@ int File_compare(File_T oNFirst, File_T oNSecond)
    assert(oNFirst != NULL);
    assert(oNSecond != NULL);
 
-   return Path_comparePath(oNFirst->path, oNSecond->path);
+   return strcmp(oNFirst->name, oNSecond->name);
 }
 
-int File_compareString(const File_T oNFirst, const char *pcSecond)
+/* Compares oNFile's name with psKey, for searching a file array. */
+static int File_compareKey(File_T oNFile, const struct nameKey *psKey)
 {
-   assert(oNFirst != NULL);
-   assert(pcSecond != NULL);
-   return Path_compareString(oNFirst->path, pcSecond);
+   return NameTable_compareKey(oNFile->name, oNFile->nameId, psKey);
+}
+
+/* A directory's files, with File_compare and File_compareKey called
+   directly */
+DYNARRAY_DEFINE_SORT(FileArray, File_T, File_compare)
+DYNARRAY_DEFINE_BSEARCH(FileArray, File_T, struct nameKey, File_compareKey)
+
+void File_sortArray(DynArray_T oDFiles, size_t ulIndex, size_t ulCount)
+{
+   assert(oDFiles != NULL);
+   assert(ulIndex + ulCount <= DynArray_getLength(oDFiles));
+
+   FileArray_sortRange(oDFiles, ulIndex, ulCount);
+}
+
+int File_bsearchArray(DynArray_T oDFiles, const struct nameKey *psKey,
+                      size_t *pulIndex)
+{
+   assert(oDFiles != NULL);
+   assert(psKey != NULL);
+   assert(pulIndex != NULL);
+
+   return FileArray_bsearch(oDFiles, psKey, pulIndex);
 }
 
 /*
@@ -54,94 +85,95 @@ int File_compareString(const File_T oNFirst, const char *pcSecond)
 */
 int File_new(Path_T oPPath, Dir_T oNParent, File_T *poNResult)
 {
-   struct fileNode *psNew;
-   Path_T oPParentPath = NULL;
-   Path_T oPNewPath = NULL;
-   size_t ulParentDepth;
    size_t ulIndex;
-   int iStatus;
 
    assert(oPPath != NULL);
    assert(oNParent != NULL);
+   assert(poNResult != NULL);
 
-   /* allocate space for a new node */
-   psNew = (struct fileNode *)calloc(1, sizeof(struct fileNode));
-   if (psNew == NULL)
+   /* validate the new node's parent */
+   /* parent must be an ancestor of child */
+   if (!Dir_isPrefixOf(oNParent, oPPath))
    {
       *poNResult = NULL;
-      return MEMORY_ERROR;
+      return CONFLICTING_PATH;
    }
 
-   /* set the new node's path */
-   iStatus = Path_dup(oPPath, &oPNewPath);
-   if (iStatus != SUCCESS)
+   /* parent must be exactly one level up from child */
+   if (Path_getDepth(oPPath) != Dir_getDepth(oNParent) + 1)
    {
-      free(psNew);
       *poNResult = NULL;
-      return iStatus;
+      return NO_SUCH_PATH;
    }
-   psNew->path = oPNewPath;
+   /* parent must not already have child with this path */
+   if (Dir_hasFile(oNParent, oPPath, &ulIndex))
+   {
+      *poNResult = NULL;
+      return ALREADY_IN_TREE;
+   }
+
+   return File_newAt(oPPath, oNParent, ulIndex, poNResult);
+}
+
+/*
+  Creates a new file like File_newAt, and makes it take over the
+  caller's reference to oPPath as its path if bAdopt is TRUE.
+*/
+static int File_create(Path_T oPPath, Dir_T oNParent, size_t ulIndex,
+                       boolean bAdopt, File_T *poNResult)
+{
+   struct fileNode *psNew;
+   Arena_T oArena;
+   size_t ulLevel;
+   struct nameKey sKey;
+   int iStatus;
 
-   /* validate and set the new node's parent */
-   if (oNParent != NULL)
+   assert(oPPath != NULL);
+   assert(oNParent != NULL);
+   assert(poNResult != NULL);
+   assert(ulIndex <= Dir_getNumFiles(oNParent));
+
+   /* allocate space for a new node, from its parent's arena */
+   oArena = Dir_getArena(oNParent);
+   psNew = (struct fileNode *)Arena_alloc(oArena, sizeof(struct fileNode));
+   if (psNew == NULL)
    {
-      size_t ulSharedDepth;
-
-      oPParentPath = Dir_getPath(oNParent);
-      ulParentDepth = Path_getDepth(oPParentPath);
-      ulSharedDepth = Path_getSharedPrefixDepth(psNew->path,
-                                                oPParentPath);
-      /* parent must be an ancestor of child */
-      if (ulSharedDepth < ulParentDepth)
-      {
-         Path_free(psNew->path);
-         free(psNew);
-         *poNResult = NULL;
-         return CONFLICTING_PATH;
-      }
-
-      /* parent must be exactly one level up from child */
-      if (Path_getDepth(psNew->path) != ulParentDepth + 1)
-      {
-         Path_free(psNew->path);
-         free(psNew);
-         *poNResult = NULL;
-         return NO_SUCH_PATH;
-      }
-      /* parent must not already have child with this path */
-      if (Dir_hasFile(oNParent, oPPath, &ulIndex))
-      {
-         Path_free(psNew->path);
-         free(psNew);
-         *poNResult = NULL;
-         return ALREADY_IN_TREE;
-      }
+      *poNResult = NULL;
+      return MEMORY_ERROR;
    }
-   else
+
+   /* set the new node's name: its parent already holds the rest */
+   ulLevel = Path_getDepth(oPPath) - 1;
+   NameTable_makeKey(&sKey, Path_getComponent(oPPath, ulLevel),
+                     Path_getComponentLength(oPPath, ulLevel),
+                     Path_getComponentHash(oPPath, ulLevel));
+   if (NameTable_intern(&sKey, &psNew->nameId) != SUCCESS)
    {
-      /* new node must be root */
-      /* can only create one "level" at a time */
-      if (Path_getDepth(psNew->path) != 1)
-      {
-         Path_free(psNew->path);
-         free(psNew);
-         *poNResult = NULL;
-         return NO_SUCH_PATH;
-      }
+      Arena_release(oArena, psNew, sizeof(struct fileNode));
+      *poNResult = NULL;
+      return MEMORY_ERROR;
    }
+   psNew->name = NameTable_getString(psNew->nameId);
+   psNew->path = bAdopt ? oPPath : NULL;
    psNew->parentDir = oNParent;
 
-   /* Link into parent's children list */
-   if (oNParent != NULL)
+   /* Link into parent's children list, and the tree-wide index */
+   iStatus = Dir_addFile(oNParent, psNew, ulIndex);
+   if (iStatus == SUCCESS)
    {
-      iStatus = Dir_addFile(oNParent, psNew, ulIndex);
+      iStatus = NodeIndex_addFile(psNew);
       if (iStatus != SUCCESS)
-      {
+         Dir_unlinkFile(oNParent, psNew);
+   }
+   if (iStatus != SUCCESS)
+   {
+      /* an adopted path is still the caller's */
+      if (!bAdopt)
          Path_free(psNew->path);
-         free(psNew);
-         *poNResult = NULL;
-         return iStatus;
-      }
+      NameTable_release(psNew->nameId);
+      Arena_release(oArena, psNew, sizeof(struct fileNode));
+      *poNResult = NULL;
+      return iStatus;
    }
    psNew->contents = NULL;
    *poNResult = psNew;
@@ -149,41 +181,74 @@ int File_new(Path_T oPPath, Dir_T oNParent, File_T *poNResult)
    return SUCCESS;
 }
 
+int File_newAt(Path_T oPPath, Dir_T oNParent, size_t ulIndex,
+               File_T *poNResult)
+{
+   return File_create(oPPath, oNParent, ulIndex, FALSE, poNResult);
+}
+
+int File_adoptAt(Path_T oPPath, Dir_T oNParent, size_t ulIndex,
+                 File_T *poNResult)
+{
+   return File_create(oPPath, oNParent, ulIndex, TRUE, poNResult);
+}
+
 /*
-  Destroys and frees all memory allocated for the subtree rooted at
-  oNNode, i.e., deletes this node and all its descendents. Returns the
-  number of nodes deleted.
+  Destroys file represented by oNNode, returns failure or success
 */
 int File_free(File_T oNNode)
 {
-   size_t ulIndex;
    assert(oNNode != NULL);
 
    /* remove from parent's list */
    if (oNNode->parentDir != NULL)
-   {
-      if (DynArray_bsearch(
-              Dir_getFiles(oNNode->parentDir),
-              oNNode, &ulIndex,
-              (int (*)(const void *, const void *))File_compare))
-         (void)DynArray_removeAt(Dir_getFiles(oNNode->parentDir),
-                                 ulIndex);
-   }
+      Dir_unlinkFile(oNNode->parentDir, oNNode);
 
-   /* remove path */
+   File_destroy(oNNode);
+   return SUCCESS;
+}
+
+/* Frees oNNode, but leaves its parent's list of files as it is. */
+void File_destroy(File_T oNNode)
+{
+   Arena_T oArena;
+   assert(oNNode != NULL);
+
+   /* remove name and path, once nothing refers to them */
+   NodeIndex_removeFile(oNNode);
    Path_free(oNNode->path);
+   oArena = Dir_getArena(oNNode->parentDir);
+   NameTable_release(oNNode->nameId);
 
    /* finally, free the struct node */
-   free(oNNode);
-   return SUCCESS;
+   Arena_release(oArena, oNNode, sizeof(struct fileNode));
 }
 
-/* Returns the path object representing oNNode's absolute path. */
+/* Returns the path object representing oNNode's absolute path,
+   building it from the names up to the root on first use. */
 Path_T File_getPath(File_T oNNode)
 {
    assert(oNNode != NULL);
+
+   if (oNNode->path == NULL)
+      (void)Dir_buildPath(Dir_getArena(oNNode->parentDir),
+                          oNNode->parentDir,
+                          oNNode->name, &oNNode->path);
    return oNNode->path;
 }
+
+/* Returns oNNode's own name, i.e., the final component of its path. */
+const char *File_getName(File_T oNNode)
+{
+   assert(oNNode != NULL);
+   return oNNode->name;
+}
+
+unsigned int File_getNameId(File_T oNNode)
+{
+   assert(oNNode != NULL);
+   return oNNode->nameId;
+}
 /*
   Returns a the parent node of oNNode.
   Returns NULL if oNNode is the root and thus has no parent.
@@ -15,6 +15,8 @@ typedef struct fileNode *File_T;
 #include <stddef.h>
 #include "a4def.h"
 #include "path.h"
+#include "dynarray.h"
+#include "nameTable.h"
 #include "dirNode.h"
 
 
@@ -23,8 +25,20 @@ typedef struct fileNode *File_T;
 /*Compared the first file oNFirst and second file oNSecond lexographically, returns int */
 int File_compare(File_T oNFirst, File_T oNSecond);
 
-/*Compares the strings contained by the oNFirst and the pcSecond, returns int.*/
-int File_compareString(const File_T oNFirst, const char *pcSecond);
+/*
+  Sorts the ulCount files in oDFiles from index ulIndex onward in the
+  order File_compare determines, as DynArray_sortRange does.
+*/
+void File_sortArray(DynArray_T oDFiles, size_t ulIndex, size_t ulCount);
+
+/*
+  Binary searches oDFiles, which is sorted as File_sortArray sorts it,
+  for the file with the name psKey, as DynArray_bsearch does: returns
+  1 and sets *pulIndex to the file's index if there is one, and
+  otherwise returns 0 and sets *pulIndex to where it would belong.
+*/
+int File_bsearchArray(DynArray_T oDFiles, const struct nameKey *psKey,
+                      size_t *pulIndex);
 
 
 /*Gets the path of oNNode, returns Path_T*/
@@ -47,14 +61,49 @@ Dir_T File_getParent(File_T oNNode);
 */
 int File_new(Path_T oPPath, Dir_T oNParent, File_T *poNResult);
 
+/*
+  Creates a new file like File_new, but trusts the caller that oPPath
+  is a new child of oNParent that belongs at index ulIndex among
+  oNParent's files, so no validation or search is repeated. Returns
+  SUCCESS and sets *poNResult to be the new file, or sets *poNResult
+  to NULL and returns MEMORY_ERROR if memory could not be allocated.
+*/
+int File_newAt(Path_T oPPath, Dir_T oNParent, size_t ulIndex,
+               File_T *poNResult);
+
+/*
+  Creates a new file like File_newAt, but instead of building a path
+  of its own when one is asked for, the file takes over the caller's
+  reference to oPPath, which must live as long as the file: File_free
+  frees it. If creation fails, oPPath is still the caller's.
+*/
+int File_adoptAt(Path_T oPPath, Dir_T oNParent, size_t ulIndex,
+                 File_T *poNResult);
+
 /*
   Destroys file represented by oNNode, returns failure or success
 */
 int File_free(File_T oNNode);
 
-/* Returns the path object representing oNNode's absolute path as a Path_T. */
+/*
+  Destroys file represented by oNNode like File_free, but without
+  removing it from its parent's list of files, which the caller is
+  about to free as a whole
+*/
+void File_destroy(File_T oNNode);
+
+/* Returns the path object representing oNNode's absolute path as a Path_T.
+   Files store only their own name, so the path is rebuilt on first use
+   and cached until oNNode is freed. Returns NULL if memory could not
+   be allocated to build it. */
 Path_T File_getPath(File_T oNNode);
 
+/* Returns oNNode's own name, i.e., the final component of its path. */
+const char *File_getName(File_T oNNode);
+
+/* Returns the id of oNNode's name in the name table. */
+unsigned int File_getNameId(File_T oNNode);
+
 /*
   Returns the parent directory of oNNode as Dir_tT
 */
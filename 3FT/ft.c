@@ -8,15 +8,21 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
 #include "ft.h"
+#include "arena.h"
 #include "dynarray.h"
 #include "path.h"
+#include "hashtable.h"
+#include "nameTable.h"
 #include "fileNode.h"
 #include "dirNode.h"
+#include "nodeIndex.h"
 #include "a4def.h"
 /*
   A File Tree is a representation of a hierarchy of directories and files,
-  represented as an AO with 3 state variables:
+  represented as an AO with 5 state variables:
 */
 
 /* 1. a flag for being in an initialized state (TRUE) or not (FALSE) */
@@ -25,248 +31,252 @@ static boolean bIsInitialized;
 static Dir_T oNRoot;
 /* 3. a counter of the number of nodes in the hierarchy */
 static size_t ulCount;
+/* 4. the arena that every node, and everything a node owns, comes
+   from, so that FT_destroy frees the hierarchy slab by slab */
+static Arena_T oArena;
+/* 5. the scratch arena for the temporaries of one operation, which
+   is reset as the operation returns, so that none of them leaks */
+static Arena_T oScratch;
 
 /* --------------------------------------------------------------------
 
-  The FT_traversePath and FT_findDir FT_findFile functions modularize the common
-  functionality of going as far as possible down an DT towards a path
-  and returning either the node of however far was reached or the
-  node if the full path was reached, respectively.
+  Every FT_* entry point parses its path once and walks down from the
+  root once, through FT_resolve. Parsing only views the caller's
+  string, so lookups allocate nothing; a Path_T is made only when
+  there are nodes to create. The walk records everything the
+  callers need: the deepest existing directory on the path, what the
+  final component is in the tree (if anything), and where the next
+  missing component would be inserted.
 */
 
+/* The outcome of walking the FT towards an absolute path */
+struct resolution
+{
+  /* the deepest directory on the path that exists, or NULL */
+  Dir_T oNDeepest;
+  /* the number of the path's components accounted for by oNDeepest */
+  size_t ulReached;
+  /* the node with the full path, if any: at most one is non-NULL */
+  Dir_T oNDir;
+  File_T oNFile;
+  /* TRUE if a proper prefix of the path exists as a file */
+  boolean bUnderFile;
+  /* the index that the component after oNDeepest has, or would be
+     inserted at, among oNDeepest's files and among its sub dirs
+     (only meaningful if the full path is not in the FT) */
+  size_t ulFileID;
+  size_t ulSubDirID;
+};
+
 /*
-  Traverses the FT starting at the root as far as possible towards
-  absolute path oPPath. If able to traverse, returns an int SUCCESS
-  status and sets *poNFurthest to the furthest node reached (which may
-  be only a prefix of oPPath, or even NULL if the root is NULL).
-  Otherwise, sets *poNFurthest to NULL and returns with status:
-  * CONFLICTING_PATH if the root's path is not a prefix of oPPath
-  * MEMORY_ERROR if memory could not be allocated to complete request
+  Walks the FT from the root as far as possible towards the absolute
+  path psView views, filling in *psRes. Returns SUCCESS, or
+  CONFLICTING_PATH if the root's path is not a prefix of that path.
+  Allocates no memory: each level is matched by the view's next
+  component, since siblings share every component but their last.
 */
-static int FT_traversePath(Path_T oPPath, Dir_T *poNFurthest)
+static int FT_resolve(struct pathView *psView, struct resolution *psRes)
 {
-  int iStatus;
-  Path_T oPPrefix = NULL;
-  Dir_T oNCurr;
   Dir_T oNChild = NULL;
+  File_T oNFile;
+  const char *pcName;
+  size_t ulNameLength;
+  struct nameKey sName;
   size_t ulDepth;
-  size_t i;
-  size_t ulChildID;
 
-  assert(oPPath != NULL);
-  assert(poNFurthest != NULL);
+  assert(psView != NULL);
+  assert(psRes != NULL);
+
+  psRes->oNDeepest = NULL;
+  psRes->ulReached = 0;
+  psRes->oNDir = NULL;
+  psRes->oNFile = NULL;
+  psRes->bUnderFile = FALSE;
+  psRes->ulFileID = 0;
+  psRes->ulSubDirID = 0;
 
   /* root is NULL -> won't find anything */
   if (oNRoot == NULL)
-  {
-    *poNFurthest = NULL;
     return SUCCESS;
-  }
 
-  iStatus = Path_prefix(oPPath, 1, &oPPrefix);
-  if (iStatus != SUCCESS)
+  ulDepth = PathView_getDepth(psView);
+
+  /* with the index on, a path that is in the FT needs no walk */
+  if (NodeIndex_isEnabled())
   {
-    *poNFurthest = NULL;
-    return iStatus;
+    psRes->oNDir = NodeIndex_getDir(PathView_getPathname(psView),
+                                    PathView_getStrLength(psView));
+    if (psRes->oNDir != NULL)
+    {
+      psRes->oNDeepest = psRes->oNDir;
+      psRes->ulReached = ulDepth;
+      return SUCCESS;
+    }
+    psRes->oNFile = NodeIndex_getFile(PathView_getPathname(psView),
+                                      PathView_getStrLength(psView));
+    if (psRes->oNFile != NULL)
+    {
+      psRes->oNDeepest = File_getParent(psRes->oNFile);
+      psRes->ulReached = ulDepth - 1;
+      return SUCCESS;
+    }
   }
 
-  if (Path_comparePath(Dir_getPath(oNRoot), oPPrefix))
-  {
-    Path_free(oPPrefix);
-    *poNFurthest = NULL;
+  /* the root's whole path is a single component */
+  pcName = PathView_getComponent(psView, 0, &ulNameLength);
+  if (strncmp(Dir_getName(oNRoot), pcName, ulNameLength) != 0 ||
+      Dir_getName(oNRoot)[ulNameLength] != '\0')
     return CONFLICTING_PATH;
-  }
-  Path_free(oPPrefix);
-  oPPrefix = NULL;
 
-  oNCurr = oNRoot;
-  /*  fprintf(stderr, "----------For pathname : %s\n", Path_getPathname(oPPath)); */
-  ulDepth = Path_getDepth(oPPath);
-  for (i = 2; i <= ulDepth; i++)
+  psRes->oNDeepest = oNRoot;
+  psRes->ulReached = 1;
+  while (psRes->ulReached < ulDepth)
   {
-    iStatus = Path_prefix(oPPath, i, &oPPrefix);
-    if (iStatus != SUCCESS)
+    pcName = PathView_getComponent(psView, psRes->ulReached,
+                                   &ulNameLength);
+    NameTable_makeKey(&sName, pcName, ulNameLength,
+                      HashTable_hash(pcName, ulNameLength));
+    oNChild = Dir_lookupSubDir(psRes->oNDeepest, &sName,
+                               &psRes->ulSubDirID);
+    if (oNChild == NULL)
     {
-      *poNFurthest = NULL;
-      return iStatus;
-    }
-    /* fprintf(stderr, "Prefix at depth %ld : %s\n", i, Path_getPathname(oPPrefix)); */
-    if (Dir_hasSubDir(oNCurr, oPPrefix, &ulChildID) == TRUE)
-    {
-      /* go to that child and continue with next prefix */
-      /* fprintf(stderr, "Has subDir at depth %ld : %s\n", i, Path_getPathname(oPPrefix)); */
-      Path_free(oPPrefix);
-      oPPrefix = NULL;
-      iStatus = Dir_getSubDir(oNCurr, ulChildID, &oNChild);
-      if (iStatus != SUCCESS)
+      /* this level is not a directory, but may be a file */
+      oNFile = Dir_lookupFile(psRes->oNDeepest, &sName,
+                              &psRes->ulFileID);
+      if (oNFile != NULL)
       {
-        *poNFurthest = NULL;
-        return iStatus;
+        if (psRes->ulReached == ulDepth - 1)
+          psRes->oNFile = oNFile;
+        else
+          psRes->bUnderFile = TRUE;
       }
-      oNCurr = oNChild;
-    }
-    else
-    {
-      /* oNCurr doesn't have child with path oPPrefix:
-         this is as far as we can go */
-      break;
+      return SUCCESS;
     }
+    psRes->oNDeepest = oNChild;
+    psRes->ulReached++;
   }
 
-  Path_free(oPPrefix);
-  *poNFurthest = oNCurr;
+  psRes->oNDir = psRes->oNDeepest;
   return SUCCESS;
 }
 
 /*
-  Traverses the DT to find a directory node with absolute path pcPath. Returns a
-  int SUCCESS status and sets *poNResult to be the node, if found.
-  Otherwise, sets *poNResult to NULL and returns with status:
-  * INITIALIZATION_ERROR if the DT is not in an initialized state
+  Validates pcPath into *psView, without copying it, and resolves it
+  into *psRes. Returns SUCCESS or one of the following statuses:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
   * BAD_PATH if pcPath does not represent a well-formatted path
   * CONFLICTING_PATH if the root's path is not a prefix of pcPath
-  * NO_SUCH_PATH if no node with pcPath exists in the hierarchy
-  * MEMORY_ERROR if memory could not be allocated to complete request
- */
-static int FT_findDir(const char *pcPath, Dir_T *poNResult)
+*/
+static int FT_parse(const char *pcPath, struct pathView *psView,
+                    struct resolution *psRes)
 {
-  Path_T oPPath = NULL;
-  Dir_T oNFound = NULL;
   int iStatus;
-  size_t ulChildID;
+
   assert(pcPath != NULL);
-  assert(poNResult != NULL);
+  assert(psView != NULL);
+  assert(psRes != NULL);
 
   if (!bIsInitialized)
-  {
-    *poNResult = NULL;
     return INITIALIZATION_ERROR;
-  }
 
-  iStatus = Path_new(pcPath, &oPPath);
+  iStatus = PathView_init(psView, pcPath);
   if (iStatus != SUCCESS)
-  {
-    *poNResult = NULL;
     return iStatus;
-  }
-/*finding the closest ancestor*/
-  iStatus = FT_traversePath(oPPath, &oNFound);
-  if (iStatus != SUCCESS)
-  {
-    Path_free(oPPath);
-    *poNResult = NULL;
-    return iStatus;
-  }
 
-  if (oNFound == NULL)
-  {
-    Path_free(oPPath);
-    *poNResult = NULL;
-    return NO_SUCH_PATH;
-  }
-  if (Dir_hasFile(oNFound, oPPath, &ulChildID))
-  {
-    return NOT_A_DIRECTORY;
-  }
-
-  if (Path_comparePath(Dir_getPath(oNFound), oPPath) != 0)
-  {
-    Path_free(oPPath);
-    *poNResult = NULL;
-    return NO_SUCH_PATH;
-  }
-
-  Path_free(oPPath);
-  *poNResult = oNFound;
-  return SUCCESS;
+  return FT_resolve(psView, psRes);
 }
+
 /*
-  Traverses the DT to find a file node with absolute path pcPath. Returns a
-  int SUCCESS status and sets *poNResult to be the node, if found.
-  Otherwise, sets *poNResult to NULL and returns with status:
-  * INITIALIZATION_ERROR if the DT is not in an initialized state
-  * BAD_PATH if pcPath does not represent a well-formatted path
-  * CONFLICTING_PATH if the root's path is not a prefix of pcPath
-  * NO_SUCH_PATH if no node with pcPath exists in the hierarchy
-  * MEMORY_ERROR if memory could not be allocated to complete request
- */
-static int FT_findFile(const char *pcPath, File_T *poNResult)
+  Creates the missing directories of oPPath from just below
+  psRes->oNDeepest down to depth ulDepth, using the insertion index
+  psRes already found for the first of them. Sets *poNFirstNew to the
+  first directory created (NULL if none were needed) and *poNLast to
+  the directory at depth ulDepth. The FT state variables are left for
+  the caller to update. Each new directory gets a prefix of oPPath,
+  which shares its memory: it adopts the prefix as its path if bAdopt
+  is TRUE, and otherwise the prefix is a temporary, left for the
+  caller to reset with oPPath's arena. Returns SUCCESS, or MEMORY_ERROR
+  after undoing any partial work if memory could not be allocated.
+*/
+static int FT_buildDirs(Path_T oPPath, const struct resolution *psRes,
+                        size_t ulDepth, boolean bAdopt,
+                        Dir_T *poNFirstNew, Dir_T *poNLast)
 {
-
+  Dir_T oNCurr = psRes->oNDeepest;
+  size_t ulLevel;
+  size_t ulIndex = psRes->ulSubDirID;
   int iStatus;
-  size_t ulIndex;
-  Dir_T oNFoundParentDir = NULL;
-  Path_T parentDirPath = NULL;
-  Path_T oPPath = NULL;
-  File_T oFile;
-  assert(pcPath != NULL);
-  assert(poNResult != NULL);
 
-  if (FT_containsDir(pcPath))
-  {
-    *poNResult = NULL;
-    return NOT_A_FILE;
-  }
+  assert(oPPath != NULL);
+  assert(poNFirstNew != NULL);
+  assert(poNLast != NULL);
 
-  iStatus = Path_new(pcPath, &oPPath);
-  if (iStatus != SUCCESS)
-  {
-    *poNResult = NULL;
-    return iStatus;
-  }
-  if (Path_getDepth(oPPath) == 1)
+  *poNFirstNew = NULL;
+  for (ulLevel = psRes->ulReached + 1; ulLevel <= ulDepth; ulLevel++)
   {
-    *poNResult = NULL;
-    return CONFLICTING_PATH;
-  }
-  Path_prefix(oPPath, Path_getDepth(oPPath) - 1, &parentDirPath);
-
-  iStatus = FT_findDir(Path_getPathname(parentDirPath), &oNFoundParentDir);
+    Path_T oPPrefix = NULL;
+    Dir_T oNNewNode = NULL;
 
-  if (iStatus != SUCCESS)
-  {
-    *poNResult = NULL;
-    return iStatus;
-  }
-  DynArray_bsearch(Dir_getFiles(oNFoundParentDir), (char *)Path_getPathname(oPPath), &ulIndex,
-                   (int (*)(const void *, const void *))File_compareString);
+    /* generate a Path_T for this level, sharing all of oPPath's
+       memory: the nodes only read it with Path_getChars */
+    iStatus = Path_prefixIn(bAdopt ? oArena : oScratch, oPPath, ulLevel,
+                            &oPPrefix);
+    if (iStatus == SUCCESS && bAdopt)
+    {
+      if (oNCurr == NULL)
+        iStatus = Dir_adoptIn(oArena, oPPrefix, &oNNewNode);
+      else
+        iStatus = Dir_adoptAt(oPPrefix, oNCurr, ulIndex, &oNNewNode);
+      if (iStatus != SUCCESS)
+        Path_free(oPPrefix);
+    }
+    else if (iStatus == SUCCESS)
+    {
+      if (oNCurr == NULL)
+        iStatus = Dir_newIn(oArena, oPPrefix, &oNNewNode);
+      else
+        iStatus = Dir_newAt(oPPrefix, oNCurr, ulIndex, &oNNewNode);
+    }
+    if (iStatus != SUCCESS)
+    {
+      if (*poNFirstNew != NULL)
+        (void)Dir_free(*poNFirstNew);
+      *poNFirstNew = NULL;
+      *poNLast = NULL;
+      return iStatus;
+    }
 
-  if (ulIndex >= Dir_getNumFiles(oNFoundParentDir))
-  {
-    *poNResult = NULL;
-    return NO_SUCH_PATH;
+    /* set up for next level: new directories start out empty */
+    oNCurr = oNNewNode;
+    if (*poNFirstNew == NULL)
+      *poNFirstNew = oNCurr;
+    ulIndex = 0;
   }
-  oFile = DynArray_get(Dir_getFiles(oNFoundParentDir), ulIndex);
-  *poNResult = oFile;
 
-  if (!Path_compareString(File_getPath(oFile), pcPath))
-  {
-    return SUCCESS;
-  }
-  else
-  {
-    *poNResult = NULL;
-    return NO_SUCH_PATH;
-  }
+  *poNLast = oNCurr;
+  return SUCCESS;
 }
 
 /*--------------------------------------------------------------------*/
 
-
 int FT_rmFile(const char *pcPath)
 {
-
-  File_T oFile;
+  struct pathView sView;
+  struct resolution sRes;
   int iStatus;
+
   assert(pcPath != NULL);
 
-  iStatus = FT_findFile(pcPath, &oFile);
+  iStatus = FT_parse(pcPath, &sView, &sRes);
   if (iStatus != SUCCESS)
-  {
     return iStatus;
-  }
-  File_free(oFile);
 
+  if (sRes.oNDir != NULL)
+    return NOT_A_FILE;
+  if (sRes.oNFile == NULL)
+    return NO_SUCH_PATH;
+
+  (void)File_free(sRes.oNFile);
   ulCount--;
 
   return SUCCESS;
@@ -278,6 +288,16 @@ int FT_init(void)
   if (bIsInitialized)
     return INITIALIZATION_ERROR;
 
+  oArena = Arena_new();
+  oScratch = Arena_new();
+  if (oArena == NULL || oScratch == NULL)
+  {
+    Arena_free(oArena);
+    Arena_free(oScratch);
+    return MEMORY_ERROR;
+  }
+  NameTable_init(oArena);
+
   bIsInitialized = TRUE;
   oNRoot = NULL;
   ulCount = 0;
@@ -292,11 +312,17 @@ int FT_destroy(void)
   if (!bIsInitialized)
     return INITIALIZATION_ERROR;
 
-  if (oNRoot)
-  {
-    ulCount -= Dir_free(oNRoot);
-    oNRoot = NULL;
-  }
+  /* drop the index and then the arena, rather than unindex and free
+     nodes one by one */
+  NodeIndex_disable();
+  Arena_free(oArena);
+  oArena = NULL;
+  Arena_free(oScratch);
+  oScratch = NULL;
+  /* the names went with the arena */
+  NameTable_init(NULL);
+  oNRoot = NULL;
+  ulCount = 0;
 
   bIsInitialized = FALSE;
 
@@ -305,29 +331,36 @@ int FT_destroy(void)
 
 boolean FT_containsDir(const char *pcPath)
 {
-  int iStatus;
-  Dir_T oNFound = NULL;
+  struct pathView sView;
+  struct resolution sRes;
 
   assert(pcPath != NULL);
 
-  iStatus = FT_findDir(pcPath, &oNFound);
-  return (boolean)(iStatus == SUCCESS);
+  if (FT_parse(pcPath, &sView, &sRes) != SUCCESS)
+    return FALSE;
+
+  return (boolean)(sRes.oNDir != NULL);
 }
 
 int FT_rmDir(const char *pcPath)
 {
+  struct pathView sView;
+  struct resolution sRes;
   int iStatus;
-  Dir_T oNFound = NULL;
 
   assert(pcPath != NULL);
 
-  iStatus = FT_findDir(pcPath, &oNFound);
-
+  iStatus = FT_parse(pcPath, &sView, &sRes);
   if (iStatus != SUCCESS)
     return iStatus;
 
-  ulCount -= Dir_free(oNFound);
-  if (ulCount == 0)
+  if (sRes.oNFile != NULL)
+    return NOT_A_DIRECTORY;
+  if (sRes.oNDir == NULL)
+    return NO_SUCH_PATH;
+
+  ulCount -= Dir_free(sRes.oNDir);
+  if (sRes.oNDir == oNRoot)
     oNRoot = NULL;
   return SUCCESS;
 }
@@ -335,117 +368,46 @@ int FT_rmDir(const char *pcPath)
 
 int FT_insertDir(const char *pcPath)
 {
-  
-  int iStatus;
-  Path_T oPPath, parentDirPath;
+  struct pathView sView;
+  Path_T oPPath;
+  struct resolution sRes;
   Dir_T oNFirstNew = NULL;
-  Dir_T oNCurr = NULL;
-  size_t ulDepth, ulIndex;
-  size_t ulNewNodes = 0;
+  Dir_T oNLast = NULL;
+  size_t ulDepth;
+  boolean bAdopt;
+  int iStatus;
 
   assert(pcPath != NULL);
 
-  /* validate pcPath and generate a Path_T for it */
-  if (!bIsInitialized)
-  {
-    return INITIALIZATION_ERROR;
-  }
-
-  if (FT_containsFile(pcPath))
-  {
-    return ALREADY_IN_TREE;
-  }
-  iStatus = Path_new(pcPath, &oPPath);
+  iStatus = FT_parse(pcPath, &sView, &sRes);
   if (iStatus != SUCCESS)
     return iStatus;
 
-  iStatus = FT_findDir(pcPath, &oNCurr);
-  if (iStatus == SUCCESS)
-  {
+  ulDepth = PathView_getDepth(&sView);
+  if (sRes.oNDir != NULL || sRes.oNFile != NULL)
     return ALREADY_IN_TREE;
-  }
-  if (Path_getDepth(oPPath) > 1)
-  {
-    Path_prefix(oPPath, Path_getDepth(oPPath) - 1, &parentDirPath);
-
-    if (FT_containsFile(Path_getPathname(parentDirPath)))
-      return NOT_A_DIRECTORY;
-
-    /* find the closest ancestor of oPPath already in the tree */
-  }
-
-  iStatus = FT_traversePath(oPPath, &oNCurr);
-  if (iStatus != SUCCESS)
-  {
-    Path_free(oPPath);
-    return iStatus;
-  }
-
-  /* no ancestor node found, so if root is not NULL,
-     pcPath isn't underneath root. */
-  if (oNCurr == NULL && oNRoot != NULL)
-  {
-    Path_free(oPPath);
-    return CONFLICTING_PATH;
-  }
-
-  ulDepth = Path_getDepth(oPPath);
-  if (oNCurr == NULL) /* new root! */
-    ulIndex = 1;
-  else
-  {
-    ulIndex = Path_getDepth(Dir_getPath(oNCurr)) + 1;
-
-    /* oNCurr is the node we're trying to insert */
-    if (ulIndex == ulDepth + 1 && !Path_comparePath(oPPath,
-                                                    Dir_getPath(oNCurr)))
-    {
-      Path_free(oPPath);
-      return ALREADY_IN_TREE;
-    }
-  }
+  if (sRes.bUnderFile)
+    return NOT_A_DIRECTORY;
 
-  /* starting at oNCurr, build rest of the path one level at a time */
-  while (ulIndex <= ulDepth)
+  /* only now is there something to build, and a Path_T to build from:
+     the nodes keep prefixes of it if the index needs their paths */
+  bAdopt = NodeIndex_isEnabled();
+  iStatus = Path_newIn(bAdopt ? oArena : oScratch, pcPath, &oPPath);
+  if (iStatus == SUCCESS)
   {
-    Path_T oPPrefix = NULL;
-    Dir_T oNNewNode = NULL;
-
-    /* generate a Path_T for this level */
-    iStatus = Path_prefix(oPPath, ulIndex, &oPPrefix);
-    if (iStatus != SUCCESS)
-    {
+    iStatus = FT_buildDirs(oPPath, &sRes, ulDepth, bAdopt, &oNFirstNew,
+                           &oNLast);
+    if (bAdopt)
       Path_free(oPPath);
-      if (oNFirstNew != NULL)
-        (void)Dir_free(oNFirstNew);
-      return iStatus;
-    }
-
-    /* insert the new node for this level */
-    iStatus = Dir_new(oPPrefix, oNCurr, &oNNewNode);
-    if (iStatus != SUCCESS)
-    {
-      Path_free(oPPath);
-      Path_free(oPPrefix);
-      if (oNFirstNew != NULL)
-        (void)Dir_free(oNFirstNew);
-      return iStatus;
-    }
-
-    /* set up for next level */
-    Path_free(oPPrefix);
-    oNCurr = oNNewNode;
-    ulNewNodes++;
-    if (oNFirstNew == NULL)
-      oNFirstNew = oNCurr;
-    ulIndex++;
   }
+  Arena_reset(oScratch);
+  if (iStatus != SUCCESS)
+    return iStatus;
 
-  Path_free(oPPath);
-  /* update DT state variables to reflect insertion */
+  /* update FT state variables to reflect insertion */
   if (oNRoot == NULL)
     oNRoot = oNFirstNew;
-  ulCount += ulNewNodes;
+  ulCount += ulDepth - sRes.ulReached;
 
   return SUCCESS;
 }
@@ -453,44 +415,50 @@ int FT_insertDir(const char *pcPath)
 
 boolean FT_containsFile(const char *pcPath)
 {
-  int iStatus;
-  File_T oNFound = NULL;
+  struct pathView sView;
+  struct resolution sRes;
 
   assert(pcPath != NULL);
 
-  iStatus = FT_findFile(pcPath, &oNFound);
-  return (boolean)(iStatus == SUCCESS);
+  if (FT_parse(pcPath, &sView, &sRes) != SUCCESS)
+    return FALSE;
+
+  return (boolean)(sRes.oNFile != NULL);
 }
 
 
 void *FT_getFileContents(const char *pcPath)
 {
-  File_T oFile;
-  int iStatus;
+  struct pathView sView;
+  struct resolution sRes;
+
   assert(pcPath != NULL);
-  iStatus = FT_findFile(pcPath, &oFile);
-  if (iStatus != SUCCESS)
-  {
+
+  if (FT_parse(pcPath, &sView, &sRes) != SUCCESS)
     return NULL;
-  }
 
-  return File_getContents(oFile);
+  if (sRes.oNFile == NULL)
+    return NULL;
+  return File_getContents(sRes.oNFile);
 }
 
 
 void *FT_replaceFileContents(const char *pcPath, void *pvNewContents,
                              size_t ulNewLength)
 {
+  struct pathView sView;
+  struct resolution sRes;
   void *retContent;
-  File_T oFile;
-  int iStatus;
+
   assert(pcPath != NULL);
-  iStatus = FT_findFile(pcPath, &oFile);
-  if (iStatus != SUCCESS)
+
+  if (FT_parse(pcPath, &sView, &sRes) != SUCCESS)
     return NULL;
-  retContent = File_getContents(oFile);
 
-  File_setContents(oFile, pvNewContents, ulNewLength);
+  if (sRes.oNFile == NULL)
+    return NULL;
+  retContent = File_getContents(sRes.oNFile);
+  (void)File_setContents(sRes.oNFile, pvNewContents, ulNewLength);
 
   return retContent;
 }
@@ -498,177 +466,272 @@ void *FT_replaceFileContents(const char *pcPath, void *pvNewContents,
 
 int FT_stat(const char *pcPath, boolean *pbIsFile, size_t *pulSize)
 {
-  Dir_T foundDir;
-  File_T foundFile;
+  struct pathView sView;
+  struct resolution sRes;
   int iStatus;
 
   assert(pcPath != NULL);
   assert(pbIsFile != NULL);
   assert(pulSize != NULL);
 
-  iStatus = FT_findDir(pcPath, &foundDir);
-  if (iStatus == SUCCESS)
-  {
-    *pbIsFile = FALSE;
-    return SUCCESS;
-  }
-  if (FT_findFile(pcPath, &foundFile) == SUCCESS)
+  iStatus = FT_parse(pcPath, &sView, &sRes);
+  if (iStatus != SUCCESS)
+    return iStatus;
+
+  if (sRes.oNFile != NULL)
   {
     *pbIsFile = TRUE;
-    *pulSize = File_getLength(foundFile);
-    return SUCCESS;
+    *pulSize = File_getLength(sRes.oNFile);
   }
-  return iStatus;
+  else if (sRes.oNDir != NULL)
+    *pbIsFile = FALSE;
+  else
+    return NO_SUCH_PATH;
+  return SUCCESS;
 }
 
 int FT_insertFile(const char *pcPath, void *pvContents, size_t ulLength)
 {
+  struct pathView sView;
+  Path_T oPPath;
+  struct resolution sRes;
+  Dir_T oNFirstNew = NULL;
+  Dir_T oNParent = NULL;
+  File_T oFile = NULL;
+  size_t ulDepth;
+  boolean bAdopt;
   int iStatus;
-  Dir_T oNFoundParentDir = NULL;
-  Path_T parentDirPath = NULL;
-  Path_T oPPath = NULL;
-  File_T oFile;
+
   assert(pcPath != NULL);
 
-  /* validate pcPath and generate a Path_T for it */
-  if (!bIsInitialized)
-    return INITIALIZATION_ERROR;
-  if (FT_containsDir(pcPath))
-  {
-    fprintf(stderr, "Already in tree dir\n");
+  iStatus = FT_parse(pcPath, &sView, &sRes);
+  if (iStatus != SUCCESS)
+    return iStatus;
+
+  ulDepth = PathView_getDepth(&sView);
+  if (sRes.oNDir != NULL || sRes.oNFile != NULL)
     return ALREADY_IN_TREE;
-  }
-  if (FT_containsFile(pcPath))
+  if (ulDepth == 1)
+    return CONFLICTING_PATH;
+  if (sRes.bUnderFile)
+    return NOT_A_DIRECTORY;
+
+  /* only now is there something to build, and a Path_T to build from:
+     the nodes keep it and prefixes of it if the index needs their
+     paths */
+  bAdopt = NodeIndex_isEnabled();
+  iStatus = Path_newIn(bAdopt ? oArena : oScratch, pcPath, &oPPath);
+  if (iStatus == SUCCESS)
   {
-    fprintf(stderr, "Already in tree file\n");
-    return ALREADY_IN_TREE;
+    iStatus = FT_buildDirs(oPPath, &sRes, ulDepth - 1, bAdopt,
+                           &oNFirstNew, &oNParent);
+    /* a freshly built parent has no files yet */
+    if (iStatus == SUCCESS && bAdopt)
+      iStatus = File_adoptAt(oPPath, oNParent,
+                             oNFirstNew == NULL ? sRes.ulFileID : 0,
+                             &oFile);
+    else if (iStatus == SUCCESS)
+      iStatus = File_newAt(oPPath, oNParent,
+                           oNFirstNew == NULL ? sRes.ulFileID : 0, &oFile);
+    if (iStatus != SUCCESS && oNFirstNew != NULL)
+      (void)Dir_free(oNFirstNew);
+    /* the file has the path now, unless there is no file */
+    if (iStatus != SUCCESS && bAdopt)
+      Path_free(oPPath);
   }
-
-  iStatus = Path_new(pcPath, &oPPath);
+  Arena_reset(oScratch);
   if (iStatus != SUCCESS)
     return iStatus;
 
-  if (Path_getDepth(oPPath) == 1)
-  {
+  (void)File_setContents(oFile, pvContents, ulLength);
 
-    fprintf(stderr, "conflicting path\n");
-    return CONFLICTING_PATH;
-  }
-  Path_prefix(oPPath, Path_getDepth(oPPath) - 1, &parentDirPath);
+  /* update FT state variables to reflect insertion */
+  if (oNRoot == NULL)
+    oNRoot = oNFirstNew;
+  ulCount += ulDepth - sRes.ulReached;
 
-  iStatus = FT_findFile(Path_getPathname(parentDirPath), &oFile);
+  return SUCCESS;
+}
 
-  if (iStatus == SUCCESS)
+/*
+  Adds oNDir and all of its descendants to the node index. Returns
+  SUCCESS, or MEMORY_ERROR if memory could not be allocated.
+*/
+static int FT_indexSubtree(Dir_T oNDir)
+{
+  struct dirIter sIter;
+  Dir_T oNCurr;
+  File_T oFile;
+  int iStep;
+  int iStatus = SUCCESS;
+
+  assert(oNDir != NULL);
+
+  DirIter_beginUnordered(&sIter, oNDir);
+  while (iStatus == SUCCESS &&
+         (iStep = DirIter_next(&sIter, &oNCurr, &oFile)) != DIR_ITER_END)
   {
-    fprintf(stderr, "Not a directory\n");
-    return NOT_A_DIRECTORY;
+    if (iStep == DIR_ITER_ENTER)
+      iStatus = NodeIndex_addDir(oNCurr);
+    else if (iStep == DIR_ITER_FILE)
+      iStatus = NodeIndex_addFile(oFile);
   }
-  iStatus = FT_findDir(Path_getPathname(parentDirPath), &oNFoundParentDir);
+  DirIter_end(&sIter);
+  return iStatus;
+}
 
-  /* appropiate parent directory found */
-  if (iStatus == SUCCESS)
-  {
+int FT_setIndexed(boolean bEnable)
+{
+  int iStatus;
 
-    File_new(oPPath, oNFoundParentDir, &oFile);
-    File_setContents(oFile, pvContents, ulLength);
-    ulCount++;
-    return SUCCESS;
-  }
+  if (!bIsInitialized)
+    return INITIALIZATION_ERROR;
 
-  iStatus = FT_insertDir(Path_getPathname(parentDirPath));
-  if (iStatus != SUCCESS)
+  if (!bEnable)
   {
-    return iStatus;
+    NodeIndex_disable();
+    return SUCCESS;
   }
-  iStatus = FT_findDir(Path_getPathname(parentDirPath), &oNFoundParentDir);
+  if (NodeIndex_isEnabled())
+    return SUCCESS;
+
+  iStatus = NodeIndex_enable();
+  if (iStatus == SUCCESS && oNRoot != NULL)
+    iStatus = FT_indexSubtree(oNRoot);
   if (iStatus != SUCCESS)
-  {
-    return iStatus;
-  }
-  File_new(oPPath, oNFoundParentDir, &oFile);
-  File_setContents(oFile, pvContents, ulLength);
-  ulCount++;
-  return SUCCESS;
+    NodeIndex_disable();
+  return iStatus;
 }
 
 /* --------------------------------------------------------------------
 
   The following auxiliary functions are used for generating the
-  string representation of the DT.
+  string representation of the FT. They walk it with a dirIter, so
+  that no depth of tree can overflow the call stack. Nodes only store
+  their names, so each line is its directory's path, a slash and its
+  name, and the walk keeps track of the length of the current
+  directory's path as it enters and leaves directories.
 */
 
 /*
-  Performs a pre-order traversal of the tree rooted at n,
-  accumulating the total string length of the string 
-  representation of the entire FT returns size_t ulLength
+  Returns the length of the path of oNDir, a directory that a walk is
+  entering or leaving, given the length ulDirLen of the path of the
+  directory the walk is in before the step.
 */
 
-static size_t FT_preOrderTraversal(Dir_T n, size_t i, size_t *ulLength)
+static size_t FT_stepDirLen(Dir_T oNDir, size_t ulDirLen, int iStep)
 {
-  size_t c;
+  size_t ulNameLen;
+
+  assert(oNDir != NULL);
+
+  ulNameLen = strlen(Dir_getName(oNDir));
+  if (Dir_getParent(oNDir) != NULL)
+    ulNameLen++;
+  if (iStep == DIR_ITER_ENTER)
+    return ulDirLen + ulNameLen;
+  return ulDirLen - ulNameLen;
+}
+
+/*
+  Performs a pre-order traversal of the tree rooted at n, and returns
+  the total string length of the string representation of the tree,
+  with a newline after every line.
+*/
+
+static size_t FT_preOrderTraversal(Dir_T n)
+{
+  struct dirIter sIter;
+  Dir_T oNDir;
   File_T oFile;
-  Dir_T oNChild = NULL;
+  int iStep;
+  size_t ulDirLen = 0;
+  size_t ulLength = 0;
 
-  if (n != NULL)
+  DirIter_begin(&sIter, n);
+  while ((iStep = DirIter_next(&sIter, &oNDir, &oFile)) != DIR_ITER_END)
   {
-    i++;
-    for (c = 0; c < Dir_getNumFiles(n); c++)
-    {
-      (void)Dir_getFile(n, c, &oFile);
-      *ulLength += (Path_getStrLength(File_getPath(oFile)) + 1);
-      i++;
-    }
-    for (c = 0; c < Dir_getNumSubDirs(n); c++)
+    if (iStep == DIR_ITER_FILE)
+      ulLength += ulDirLen + 1 + strlen(File_getName(oFile)) + 1;
+    else
     {
-      int iStatus;
-      oNChild = NULL;
-      iStatus = Dir_getSubDir(n, c, &oNChild);
-      *ulLength += (Path_getStrLength(Dir_getPath(oNChild)) + 1);
-      assert(iStatus == SUCCESS);
-      i = FT_preOrderTraversal(oNChild, i, ulLength);
+      ulDirLen = FT_stepDirLen(oNDir, ulDirLen, iStep);
+      if (iStep == DIR_ITER_ENTER)
+        ulLength += ulDirLen + 1;
     }
   }
-  return i;
+  DirIter_end(&sIter);
+  return ulLength;
 }
 
 /*
-  Performs a pre-order traversal of the tree rooted at n,
-  accumulating the total string of the string 
-  representation of the entire FT in retString. also accumulates
-  the number of nodes passed through in i and returns it.
+  Writes a line to pcCursor that consists of the ulPrefixLen
+  characters at pcPrefix and a slash (unless ulPrefixLen is 0), then
+  pcName and a newline. Returns the position just past the line.
 */
 
-static size_t FT_preOrderStringTraversal(Dir_T n, size_t i, char *retString)
+static char *FT_writeLine(char *pcCursor, const char *pcPrefix,
+                          size_t ulPrefixLen, const char *pcName)
 {
+  size_t ulNameLen;
+
+  assert(pcCursor != NULL);
+  assert(pcName != NULL);
 
-  size_t c;
+  if (ulPrefixLen != 0)
+  {
+    memcpy(pcCursor, pcPrefix, ulPrefixLen);
+    pcCursor += ulPrefixLen;
+    *pcCursor++ = '/';
+  }
+  ulNameLen = strlen(pcName);
+  memcpy(pcCursor, pcName, ulNameLen);
+  pcCursor += ulNameLen;
+  *pcCursor++ = '\n';
+  return pcCursor;
+}
+
+/*
+  Performs a pre-order traversal of the tree rooted at n, writing the
+  string representation of the tree at pcCursor, which
+  FT_preOrderTraversal has already sized. The path of the current
+  directory is always a prefix of the line of the last directory
+  entered, so lines are copied from earlier output. Returns the
+  position just past the last line written, so no append ever
+  rescans the output.
+*/
+
+static char *FT_preOrderStringTraversal(Dir_T n, char *pcCursor)
+{
+  struct dirIter sIter;
+  Dir_T oNDir;
   File_T oFile;
-  Dir_T oNChild = NULL;
+  int iStep;
+  const char *pcDir = pcCursor;
+  size_t ulDirLen = 0;
 
-  assert(retString != NULL);
-  if (n != NULL)
+  assert(pcCursor != NULL);
+
+  DirIter_begin(&sIter, n);
+  while ((iStep = DirIter_next(&sIter, &oNDir, &oFile)) != DIR_ITER_END)
   {
-    strcat(retString, Path_getPathname(Dir_getPath(n)));
-    strcat(retString, "\n");
-    i++;
-    for (c = 0; c < Dir_getNumFiles(n); c++)
-    {
-      (void)Dir_getFile(n, c, &oFile);
-      strcat(retString, Path_getPathname(File_getPath(oFile)));
-      strcat(retString, "\n");
-      i++;
-    }
-    for (c = 0; c < Dir_getNumSubDirs(n); c++)
+    if (iStep == DIR_ITER_FILE)
+      pcCursor = FT_writeLine(pcCursor, pcDir, ulDirLen,
+                              File_getName(oFile));
+    else if (iStep == DIR_ITER_ENTER)
     {
-      int iStatus;
-      oNChild = NULL;
-      iStatus = Dir_getSubDir(n, c, &oNChild);
-      assert(iStatus == SUCCESS);
+      const char *pcLine = pcCursor;
 
-      i = FT_preOrderStringTraversal(oNChild, i, retString);
+      pcCursor = FT_writeLine(pcCursor, pcDir, ulDirLen,
+                              Dir_getName(oNDir));
+      pcDir = pcLine;
+      ulDirLen = FT_stepDirLen(oNDir, ulDirLen, iStep);
     }
+    else
+      ulDirLen = FT_stepDirLen(oNDir, ulDirLen, iStep);
   }
-  return i;
+  DirIter_end(&sIter);
+  return pcCursor;
 }
 
 
@@ -676,20 +739,334 @@ char *FT_toString(void)
 {
   size_t totalStrlen = 1;
   char *ret = NULL;
+  char *pcEnd;
 
   if (!bIsInitialized)
     return NULL;
 
-  (void)FT_preOrderTraversal(oNRoot, 0, &totalStrlen);
+  totalStrlen += FT_preOrderTraversal(oNRoot);
 
   ret = malloc(totalStrlen);
   if (ret == NULL)
   {
     return NULL;
   }
-  *ret = '\0';
 
-  (void)FT_preOrderStringTraversal(oNRoot, 0, ret);
+  pcEnd = FT_preOrderStringTraversal(oNRoot, ret);
+  assert((size_t)(pcEnd - ret) == totalStrlen - 1);
+  *pcEnd = '\0';
 
   return ret;
-}
\ No newline at end of file
+}
+
+/* --------------------------------------------------------------------
+
+  The FT iterator yields the path of every node in the order of
+  FT_toString, building each one in a buffer that only grows with the
+  longest path seen.
+*/
+
+/* A walk of the FT, for FT_iter* and the streaming writers */
+struct ftIter
+{
+  /* the walk over the nodes */
+  struct dirIter sDirIter;
+  /* the path last returned, and the capacity of its buffer */
+  char *pcPath;
+  size_t ulPathCap;
+  /* the length of the path last returned */
+  size_t ulPathLen;
+  /* the length of the path of the directory the walk is in */
+  size_t ulDirLen;
+  /* whether the last path returned was a directory's */
+  boolean bAtDir;
+};
+
+/* Starts *psIter on a walk of the whole FT. */
+
+static void FT_iterInit(struct ftIter *psIter)
+{
+  assert(psIter != NULL);
+
+  DirIter_begin(&psIter->sDirIter, oNRoot);
+  psIter->pcPath = NULL;
+  psIter->ulPathCap = 0;
+  psIter->ulPathLen = 0;
+  psIter->ulDirLen = 0;
+  psIter->bAtDir = FALSE;
+}
+
+/*
+  Makes room for a path of ulLength characters and its '\0' in
+  psIter's buffer, keeping what is there. Returns SUCCESS, or
+  MEMORY_ERROR if memory could not be allocated.
+*/
+
+static int FT_iterReserve(struct ftIter *psIter, size_t ulLength)
+{
+  char *pcNew;
+
+  assert(psIter != NULL);
+
+  if (ulLength < psIter->ulPathCap)
+    return SUCCESS;
+  pcNew = realloc(psIter->pcPath, 2 * ulLength);
+  if (pcNew == NULL)
+    return MEMORY_ERROR;
+  psIter->pcPath = pcNew;
+  psIter->ulPathCap = 2 * ulLength;
+  return SUCCESS;
+}
+
+/*
+  Advances *psIter as FT_iterNext does, and also leaves the length of
+  the path in psIter->ulPathLen.
+*/
+
+static int FT_iterStep(struct ftIter *psIter, const char **ppcPath,
+                       boolean *pbIsFile)
+{
+  Dir_T oNDir;
+  File_T oFile;
+  const char *pcName;
+  size_t ulNameLen;
+  size_t ulPrefixLen;
+  int iStep;
+
+  assert(psIter != NULL);
+  assert(ppcPath != NULL);
+  assert(pbIsFile != NULL);
+
+  while ((iStep = DirIter_next(&psIter->sDirIter, &oNDir, &oFile))
+         == DIR_ITER_LEAVE)
+    psIter->ulDirLen = FT_stepDirLen(oNDir, psIter->ulDirLen, iStep);
+  if (iStep == DIR_ITER_END)
+  {
+    psIter->bAtDir = FALSE;
+    return NO_SUCH_PATH;
+  }
+
+  /* the path is the current directory's, then a slash and the name */
+  ulPrefixLen = psIter->ulDirLen;
+  if (iStep == DIR_ITER_FILE)
+    pcName = File_getName(oFile);
+  else
+  {
+    pcName = Dir_getName(oNDir);
+    psIter->ulDirLen = FT_stepDirLen(oNDir, psIter->ulDirLen, iStep);
+  }
+  ulNameLen = strlen(pcName);
+  psIter->ulPathLen = ulNameLen;
+  if (ulPrefixLen != 0)
+    psIter->ulPathLen += ulPrefixLen + 1;
+  if (FT_iterReserve(psIter, psIter->ulPathLen) != SUCCESS)
+    return MEMORY_ERROR;
+  if (ulPrefixLen != 0)
+    psIter->pcPath[ulPrefixLen] = '/';
+  memcpy(psIter->pcPath + psIter->ulPathLen - ulNameLen, pcName,
+         ulNameLen);
+  psIter->pcPath[psIter->ulPathLen] = '\0';
+
+  psIter->bAtDir = (boolean)(iStep == DIR_ITER_ENTER);
+  *ppcPath = psIter->pcPath;
+  *pbIsFile = (boolean)!psIter->bAtDir;
+  return SUCCESS;
+}
+
+/* Frees what *psIter allocated. */
+
+static void FT_iterFinish(struct ftIter *psIter)
+{
+  assert(psIter != NULL);
+
+  DirIter_end(&psIter->sDirIter);
+  free(psIter->pcPath);
+}
+
+int FT_iterBegin(FT_Iter_T *poIter)
+{
+  struct ftIter *psIter;
+
+  assert(poIter != NULL);
+
+  *poIter = NULL;
+  if (!bIsInitialized)
+    return INITIALIZATION_ERROR;
+
+  psIter = malloc(sizeof(struct ftIter));
+  if (psIter == NULL)
+    return MEMORY_ERROR;
+  FT_iterInit(psIter);
+
+  *poIter = psIter;
+  return SUCCESS;
+}
+
+int FT_iterNext(FT_Iter_T oIter, const char **ppcPath, boolean *pbIsFile)
+{
+  assert(oIter != NULL);
+
+  return FT_iterStep(oIter, ppcPath, pbIsFile);
+}
+
+void FT_iterSkip(FT_Iter_T oIter)
+{
+  assert(oIter != NULL);
+
+  if (oIter->bAtDir)
+    DirIter_skipChildren(&oIter->sDirIter);
+}
+
+void FT_iterEnd(FT_Iter_T oIter)
+{
+  if (oIter == NULL)
+    return;
+
+  FT_iterFinish(oIter);
+  free(oIter);
+}
+
+/* --------------------------------------------------------------------
+
+  The following auxiliary functions stream the same representation
+  to a FILE * or a file descriptor, through a fixed-size buffer, so
+  that the output never has to fit in memory at once. The lines come
+  from an ftIter walk.
+*/
+
+/* The number of bytes that a writer collects before each write */
+#define WRITE_BUFFER_SIZE 65536
+
+/* A buffered sink for the string representation of the FT */
+struct writer
+{
+  /* the stream to write to, or NULL to write to iFd instead */
+  FILE *psFile;
+  /* the file descriptor to write to if psFile is NULL */
+  int iFd;
+  /* SUCCESS until something fails, and then the reason why */
+  int iStatus;
+  /* the number of bytes waiting in acBuf */
+  size_t ulUsed;
+  char acBuf[WRITE_BUFFER_SIZE];
+};
+
+/*
+  Writes out the bytes waiting in psWriter's buffer, as one batch.
+  Sets psWriter->iStatus to EOF if writing fails.
+*/
+
+static void FT_flush(struct writer *psWriter)
+{
+  size_t ulDone = 0;
+  ssize_t lWritten;
+
+  assert(psWriter != NULL);
+
+  if (psWriter->psFile != NULL)
+  {
+    if (fwrite(psWriter->acBuf, 1, psWriter->ulUsed, psWriter->psFile)
+        != psWriter->ulUsed)
+      psWriter->iStatus = EOF;
+  }
+  else
+  {
+    while (ulDone < psWriter->ulUsed)
+    {
+      lWritten = write(psWriter->iFd, psWriter->acBuf + ulDone,
+                       psWriter->ulUsed - ulDone);
+      if (lWritten < 0)
+      {
+        if (errno == EINTR)
+          continue;
+        psWriter->iStatus = EOF;
+        break;
+      }
+      ulDone += (size_t)lWritten;
+    }
+  }
+  psWriter->ulUsed = 0;
+}
+
+/* Appends the ulLength bytes at pc to psWriter's output. */
+
+static void FT_put(struct writer *psWriter, const char *pc,
+                   size_t ulLength)
+{
+  size_t ulChunk;
+
+  assert(psWriter != NULL);
+  assert(pc != NULL);
+
+  while (ulLength > 0 && psWriter->iStatus == SUCCESS)
+  {
+    ulChunk = WRITE_BUFFER_SIZE - psWriter->ulUsed;
+    if (ulChunk > ulLength)
+      ulChunk = ulLength;
+    memcpy(psWriter->acBuf + psWriter->ulUsed, pc, ulChunk);
+    psWriter->ulUsed += ulChunk;
+    pc += ulChunk;
+    ulLength -= ulChunk;
+    if (psWriter->ulUsed == WRITE_BUFFER_SIZE)
+      FT_flush(psWriter);
+  }
+}
+
+/*
+  Writes the string representation of the FT to psFile, or to iFd if
+  psFile is NULL. Returns the status described for FT_writeTo.
+*/
+
+static int FT_write(FILE *psFile, int iFd)
+{
+  struct writer *psWriter;
+  struct ftIter sIter;
+  const char *pcPath;
+  boolean bIsFile;
+  int iStatus;
+
+  if (!bIsInitialized)
+    return INITIALIZATION_ERROR;
+
+  psWriter = malloc(sizeof(struct writer));
+  if (psWriter == NULL)
+    return MEMORY_ERROR;
+  psWriter->psFile = psFile;
+  psWriter->iFd = iFd;
+  psWriter->iStatus = SUCCESS;
+  psWriter->ulUsed = 0;
+
+  FT_iterInit(&sIter);
+  while (psWriter->iStatus == SUCCESS &&
+         (iStatus = FT_iterStep(&sIter, &pcPath, &bIsFile)) != NO_SUCH_PATH)
+  {
+    if (iStatus != SUCCESS)
+      psWriter->iStatus = iStatus;
+    else
+    {
+      FT_put(psWriter, pcPath, sIter.ulPathLen);
+      FT_put(psWriter, "\n", 1);
+    }
+  }
+  FT_iterFinish(&sIter);
+  if (psWriter->iStatus == SUCCESS)
+    FT_flush(psWriter);
+
+  iStatus = psWriter->iStatus;
+  free(psWriter);
+  return iStatus;
+}
+
+int FT_writeTo(FILE *psFile)
+{
+  assert(psFile != NULL);
+
+  return FT_write(psFile, -1);
+}
+
+int FT_writeToFd(int iFd)
+{
+  assert(iFd >= 0);
+
+  return FT_write(NULL, iFd);
+}
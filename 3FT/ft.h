@@ -13,6 +13,7 @@
 */
 
 #include <stddef.h>
+#include <stdio.h>
 #include "a4def.h"
 
 
@@ -120,10 +121,24 @@ void *FT_replaceFileContents(const char *pcPath, void *pvNewContents,
 */
 int FT_stat(const char *pcPath, boolean *pbIsFile, size_t *pulSize);
 
+/*
+  Turns the FT's whole-tree path index on if bEnable is TRUE, or off
+  if it is FALSE. While the index is on, looking up a path that is in
+  the FT takes O(1) expected time instead of a walk from the root, at
+  the cost of one hash table entry per node. Turning the index on
+  indexes the current hierarchy. The index starts out off after
+  FT_init, and FT_destroy turns it off.
+  Returns SUCCESS, or:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * MEMORY_ERROR if memory could not be allocated to complete request
+*/
+int FT_setIndexed(boolean bEnable);
+
 /*
   Sets the FT data structure to an initialized state.
   The data structure is initially empty.
   Returns INITIALIZATION_ERROR if already initialized,
+  MEMORY_ERROR if memory could not be allocated for it,
   and SUCCESS otherwise.
 */
 int FT_init(void);
@@ -150,4 +165,60 @@ int FT_destroy(void);
 */
 char *FT_toString(void);
 
+/*
+  An FT_Iter_T walks the FT in the order of FT_toString, one node at
+  a time, with an explicit stack rather than recursion, so any depth
+  of tree can be walked without copying it into a string. The FT must
+  not be changed during the walk.
+*/
+typedef struct ftIter *FT_Iter_T;
+
+/*
+  Starts a walk of the FT, and sets *poIter to it.
+  Returns SUCCESS, or sets *poIter to NULL and returns:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * MEMORY_ERROR if memory could not be allocated to complete request
+*/
+int FT_iterBegin(FT_Iter_T *poIter);
+
+/*
+  Advances oIter to the next node, and sets *ppcPath to its absolute
+  path, which stays valid until the next call, and *pbIsFile to
+  whether it is a file. Allocates nothing per node, only when a path
+  is longer than any before it. Returns SUCCESS, or:
+  * NO_SUCH_PATH if the walk is over
+  * MEMORY_ERROR if memory could not be allocated to complete request,
+                 after which oIter can only be ended
+*/
+int FT_iterNext(FT_Iter_T oIter, const char **ppcPath, boolean *pbIsFile);
+
+/*
+  Skips everything below the directory that FT_iterNext returned last,
+  so that the walk continues after its subtree. Does nothing if the
+  last node returned was a file.
+*/
+void FT_iterSkip(FT_Iter_T oIter);
+
+/* Ends the walk oIter and frees it. oIter may be NULL. */
+void FT_iterEnd(FT_Iter_T oIter);
+
+/*
+  Writes the same representation as FT_toString, without the
+  trailing '\0', to psFile, through a fixed-size buffer and in large
+  batches, so that it never has to be held in memory at once.
+  Returns SUCCESS, or:
+  * INITIALIZATION_ERROR if the FT is not in an initialized state
+  * MEMORY_ERROR if memory could not be allocated to complete request
+  * EOF if a write failed, in which case ferror(psFile) is set
+  Output written before a failure is not taken back.
+*/
+int FT_writeTo(FILE *psFile);
+
+/*
+  Writes the same representation as FT_writeTo to the open file
+  descriptor iFd, with the same return values, except that errno
+  tells why a write failed.
+*/
+int FT_writeToFd(int iFd);
+
 #endif
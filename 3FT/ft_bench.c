@@ -0,0 +1,1048 @@
+/*--------------------------------------------------------------------*/
+/* ft_bench.c                                                         */
+/* Author: Roy Mazumder and Roshaan Khalid                            */
+/*--------------------------------------------------------------------*/
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "ft.h"
+#include "dirNode.h"
+#include "fileNode.h"
+#include "nameTable.h"
+#include "arena.h"
+#include "hashtable.h"
+#include "btree.h"
+#include "path.h"
+#include "dynarray.h"
+#include "typedarray.h"
+#include "a4def.h"
+
+/*
+  Benchmarks of the FT. Each one builds the trees it needs, times the
+  operations it is about and prints one line per measurement. Run as
+  ft_bench to run them all, or as ft_bench followed by the names of
+  the ones to run.
+*/
+
+/* The longest pathname that a benchmark builds */
+enum { MAX_PATH_LENGTH = 256 };
+
+/* Returns the processor time used so far, in seconds. */
+static double Bench_now(void)
+{
+   return (double)clock() / CLOCKS_PER_SEC;
+}
+
+/*
+  Exits with a message if iStatus, what an FT_* or Path_* call
+  returned, is not SUCCESS. Benchmarks only measure calls that work.
+*/
+static void Bench_check(int iStatus)
+{
+   if (iStatus != SUCCESS)
+   {
+      fprintf(stderr, "ft_bench: a call failed with status %d\n",
+              iStatus);
+      exit(EXIT_FAILURE);
+   }
+}
+
+/* The last number in Bench_random's sequence */
+static unsigned long ulRandom = 1;
+
+/*
+  Returns the next of a sequence of pseudo-random numbers below 2^31,
+  the same on every platform, which starts again after
+  Bench_seedRandom.
+*/
+static size_t Bench_random(void)
+{
+   ulRandom = (ulRandom * 1103515245UL + 12345UL) & 0x7fffffffUL;
+   return (size_t)ulRandom;
+}
+
+/* Starts the sequence of Bench_random over. */
+static void Bench_seedRandom(void)
+{
+   ulRandom = 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/*
+  The bench target links ft_bench with --wrap for malloc, calloc,
+  realloc and free, so that every call to them from the FT comes here
+  first, to be counted. Each block gets a header that records its
+  size, so that the bytes in use can be kept track of too.
+*/
+
+/* The header in front of each block, padded to keep the block aligned */
+union allocHeader
+{
+   size_t ulSize;
+   long double ldAlign;
+   void *pvAlign;
+};
+
+/* The counts the wrappers keep */
+struct allocStats
+{
+   /* the number of blocks allocated, reallocations included */
+   size_t ulAllocs;
+   /* the number of bytes asked for by those calls */
+   size_t ulBytes;
+   /* the number of bytes in blocks that are not freed yet */
+   size_t ulInUse;
+};
+
+static struct allocStats sAllocStats;
+
+void *__real_malloc(size_t ulSize);
+void *__real_realloc(void *pv, size_t ulSize);
+void __real_free(void *pv);
+
+/* Counts a block of ulSize bytes whose header is at psHeader, if it
+   is not NULL, and returns the block. */
+static void *Bench_countAlloc(union allocHeader *psHeader, size_t ulSize)
+{
+   if (psHeader == NULL)
+      return NULL;
+   psHeader->ulSize = ulSize;
+   sAllocStats.ulAllocs++;
+   sAllocStats.ulBytes += ulSize;
+   sAllocStats.ulInUse += ulSize;
+   return psHeader + 1;
+}
+
+void *__wrap_malloc(size_t ulSize)
+{
+   return Bench_countAlloc(
+      __real_malloc(sizeof(union allocHeader) + ulSize), ulSize);
+}
+
+void *__wrap_calloc(size_t ulCount, size_t ulSize)
+{
+   void *pv;
+
+   if (ulSize != 0 && ulCount > ((size_t)-1 - sizeof(union allocHeader))
+                                / ulSize)
+      return NULL;
+   pv = __wrap_malloc(ulCount * ulSize);
+   if (pv != NULL)
+      memset(pv, 0, ulCount * ulSize);
+   return pv;
+}
+
+void __wrap_free(void *pv)
+{
+   union allocHeader *psHeader;
+
+   if (pv == NULL)
+      return;
+   psHeader = (union allocHeader *)pv - 1;
+   sAllocStats.ulInUse -= psHeader->ulSize;
+   __real_free(psHeader);
+}
+
+void *__wrap_realloc(void *pv, size_t ulSize)
+{
+   union allocHeader *psHeader;
+   size_t ulOldSize;
+
+   if (pv == NULL)
+      return __wrap_malloc(ulSize);
+   psHeader = (union allocHeader *)pv - 1;
+   ulOldSize = psHeader->ulSize;
+   psHeader = __real_realloc(psHeader,
+                             sizeof(union allocHeader) + ulSize);
+   if (psHeader == NULL)
+      return NULL;
+   sAllocStats.ulInUse -= ulOldSize;
+   return Bench_countAlloc(psHeader, ulSize);
+}
+
+/*--------------------------------------------------------------------*/
+
+/*
+  Times FT_rmDir on a directory of WIDTH files and WIDTH sub dirs, and
+  on a chain of DEPTH directories, each the only child of the last:
+  the worst cases for freeing a subtree a child at a time and for
+  freeing it recursively.
+*/
+static void Bench_rm(void)
+{
+   enum { WIDTH = 200000, DEPTH = 100000 };
+   char acPath[MAX_PATH_LENGTH];
+   char *pcDeep;
+   size_t ulIndex;
+   double dStart;
+
+   Bench_check(FT_init());
+   for (ulIndex = 0; ulIndex < WIDTH; ulIndex++)
+   {
+      sprintf(acPath, "r/logs/f%07lu", (unsigned long)ulIndex);
+      Bench_check(FT_insertFile(acPath, NULL, 0));
+      sprintf(acPath, "r/logs/d%07lu", (unsigned long)ulIndex);
+      Bench_check(FT_insertDir(acPath));
+   }
+   dStart = Bench_now();
+   Bench_check(FT_rmDir("r/logs"));
+   printf("rm: wide, %d files and %d dirs: %.4f s\n", WIDTH, WIDTH,
+          Bench_now() - dStart);
+   Bench_check(FT_destroy());
+
+   /* "a/a/.../a", built with one FT_insertDir */
+   pcDeep = malloc(2 * DEPTH);
+   if (pcDeep == NULL)
+      Bench_check(MEMORY_ERROR);
+   for (ulIndex = 0; ulIndex < DEPTH; ulIndex++)
+   {
+      pcDeep[2 * ulIndex] = 'a';
+      pcDeep[2 * ulIndex + 1] = '/';
+   }
+   pcDeep[2 * DEPTH - 1] = '\0';
+   Bench_check(FT_init());
+   Bench_check(FT_insertDir(pcDeep));
+   dStart = Bench_now();
+   Bench_check(FT_rmDir("a/a"));
+   printf("rm: deep, %d levels: %.4f s\n", DEPTH, Bench_now() - dStart);
+   Bench_check(FT_destroy());
+   free(pcDeep);
+}
+
+/*
+  Times FT_toString on trees of 1,000 to 10,000,000 files, 100 to a
+  directory, to show that it takes time linear in the size of the tree.
+*/
+static void Bench_toString(void)
+{
+   enum { MIN_NODES = 1000, MAX_NODES = 10000000, FILES_PER_DIR = 100 };
+   char acPath[MAX_PATH_LENGTH];
+   char *pcString;
+   size_t ulNodes;
+   size_t ulIndex;
+   double dStart;
+   double dTime;
+
+   for (ulNodes = MIN_NODES; ulNodes <= MAX_NODES; ulNodes *= 10)
+   {
+      Bench_check(FT_init());
+      for (ulIndex = 0; ulIndex < ulNodes; ulIndex++)
+      {
+         sprintf(acPath, "r/d%lu/f%lu",
+                 (unsigned long)(ulIndex / FILES_PER_DIR),
+                 (unsigned long)ulIndex);
+         Bench_check(FT_insertFile(acPath, NULL, 0));
+      }
+      dStart = Bench_now();
+      pcString = FT_toString();
+      dTime = Bench_now() - dStart;
+      if (pcString == NULL)
+         Bench_check(MEMORY_ERROR);
+      printf("toString: %lu files: %.4f s, %.1f ns per file\n",
+             (unsigned long)ulNodes, dTime, 1e9 * dTime / ulNodes);
+      free(pcString);
+      Bench_check(FT_destroy());
+   }
+}
+
+/* The number of children of each directory in the build tree */
+enum { FANOUT = 100 };
+
+/*
+  Writes to acPath the path of file ulFile of the build tree, a tree of
+  FANOUT directories of FANOUT directories of FANOUT files each, under
+  a few levels that every path shares.
+*/
+static void Bench_buildTreePath(char acPath[], size_t ulFile)
+{
+   sprintf(acPath, "root/build/artifacts/d%03lu/sub%03lu/obj/file%03lu.o",
+           (unsigned long)(ulFile / (FANOUT * FANOUT)),
+           (unsigned long)(ulFile / FANOUT % FANOUT),
+           (unsigned long)(ulFile % FANOUT));
+}
+
+/*
+  Times FT_containsFile on random files of the build tree, which has
+  over a million nodes, first walking down from the root and then
+  through the whole-tree index.
+*/
+static void Bench_index(void)
+{
+   enum { FILES = FANOUT * FANOUT * FANOUT, LOOKUPS = 1000000 };
+   char acPath[MAX_PATH_LENGTH];
+   size_t ulIndex;
+   size_t ulHits;
+   int iIndexed;
+   double dStart;
+   double dTime;
+
+   Bench_check(FT_init());
+   for (ulIndex = 0; ulIndex < FILES; ulIndex++)
+   {
+      Bench_buildTreePath(acPath, ulIndex);
+      Bench_check(FT_insertFile(acPath, NULL, 0));
+   }
+   for (iIndexed = 0; iIndexed <= 1; iIndexed++)
+   {
+      Bench_check(FT_setIndexed((boolean)iIndexed));
+      /* the same lookups both times */
+      Bench_seedRandom();
+      ulHits = 0;
+      dStart = Bench_now();
+      for (ulIndex = 0; ulIndex < LOOKUPS; ulIndex++)
+      {
+         Bench_buildTreePath(acPath, Bench_random() % FILES);
+         ulHits += FT_containsFile(acPath);
+      }
+      dTime = Bench_now() - dStart;
+      if (ulHits != LOOKUPS)
+         Bench_check(NO_SUCH_PATH);
+      printf("index: %d files, %s: %.1f ns per lookup\n", FILES,
+             iIndexed ? "indexed" : "walk", 1e9 * dTime / LOOKUPS);
+   }
+   Bench_check(FT_destroy());
+}
+
+/*
+  Counts the allocations that lookups make, walking and through the
+  index: FT_containsFile and FT_stat on random files of a build tree
+  of LOOKUP_FILES files, and FT_containsDir on one of its directories.
+  None of them has anything to allocate.
+*/
+static void Bench_lookup(void)
+{
+   enum { LOOKUP_FILES = 20000, LOOKUPS = 100000 };
+   char acPath[MAX_PATH_LENGTH];
+   size_t ulIndex;
+   size_t ulHits;
+   size_t ulAllocs;
+   size_t ulSize;
+   boolean bIsFile;
+   int iIndexed;
+   double dStart;
+   double dTime;
+
+   Bench_check(FT_init());
+   for (ulIndex = 0; ulIndex < LOOKUP_FILES; ulIndex++)
+   {
+      Bench_buildTreePath(acPath, ulIndex);
+      Bench_check(FT_insertFile(acPath, NULL, 0));
+   }
+   for (iIndexed = 0; iIndexed <= 1; iIndexed++)
+   {
+      Bench_check(FT_setIndexed((boolean)iIndexed));
+      Bench_seedRandom();
+      ulHits = 0;
+      ulAllocs = sAllocStats.ulAllocs;
+      dStart = Bench_now();
+      for (ulIndex = 0; ulIndex < LOOKUPS; ulIndex++)
+      {
+         Bench_buildTreePath(acPath, Bench_random() % LOOKUP_FILES);
+         ulHits += FT_containsFile(acPath);
+         ulHits += FT_stat(acPath, &bIsFile, &ulSize) == SUCCESS;
+         ulHits += FT_containsDir("root/build/artifacts/d001/sub001");
+      }
+      dTime = Bench_now() - dStart;
+      ulAllocs = sAllocStats.ulAllocs - ulAllocs;
+      if (ulHits != 3 * LOOKUPS)
+         Bench_check(NO_SUCH_PATH);
+      printf("lookup: depth 7, %s: %.1f ns and %.2f allocations "
+             "per lookup\n", iIndexed ? "indexed" : "walk",
+             1e9 * dTime / (3 * LOOKUPS), (double)ulAllocs / (3 * LOOKUPS));
+   }
+   Bench_check(FT_destroy());
+}
+
+/*
+  Inserts the file at pcPath, with the directories it needs, into the
+  tree at *poNRoot, whose nodes come from oArena, like FT_insertFile.
+  With bAdopt, the new nodes adopt the paths that the insert parsed,
+  as FT_insertFile makes them do when the index is on; without it,
+  they are made by Dir_newAt and File_newAt, so that the index builds
+  each one a path of its own, and the insert's paths come from
+  oScratch and are freed again.
+*/
+static void Bench_insertNodes(Arena_T oArena, Arena_T oScratch,
+                              Dir_T *poNRoot, const char *pcPath,
+                              boolean bAdopt)
+{
+   Arena_T oPathArena = bAdopt ? oArena : oScratch;
+   struct nameKey sKey;
+   Path_T oPPath;
+   Path_T oPPrefix;
+   Dir_T oNCurr = NULL;
+   Dir_T oNChild;
+   File_T oNFile;
+   size_t ulDepth;
+   size_t ulLevel;
+   size_t ulIndex = 0;
+
+   Bench_check(Path_newIn(oPathArena, pcPath, &oPPath));
+   ulDepth = Path_getDepth(oPPath);
+   for (ulLevel = 1; ulLevel < ulDepth; ulLevel++)
+   {
+      /* walk by name, as FT_insertFile does, so only a new directory
+         costs a prefix */
+      NameTable_makeKey(&sKey, Path_getComponent(oPPath, ulLevel - 1),
+                        Path_getComponentLength(oPPath, ulLevel - 1),
+                        Path_getComponentHash(oPPath, ulLevel - 1));
+      if (oNCurr == NULL)
+         oNChild = *poNRoot;
+      else
+         oNChild = Dir_lookupSubDir(oNCurr, &sKey, &ulIndex);
+      if (oNChild == NULL)
+      {
+         Bench_check(Path_prefixIn(oPathArena, oPPath, ulLevel,
+                                   &oPPrefix));
+         if (bAdopt && oNCurr == NULL)
+            Bench_check(Dir_adoptIn(oArena, oPPrefix, &oNChild));
+         else if (bAdopt)
+            Bench_check(Dir_adoptAt(oPPrefix, oNCurr, ulIndex, &oNChild));
+         else if (oNCurr == NULL)
+            Bench_check(Dir_newIn(oArena, oPPrefix, &oNChild));
+         else
+            Bench_check(Dir_newAt(oPPrefix, oNCurr, ulIndex, &oNChild));
+         /* an adopting node owns the prefix now */
+         if (!bAdopt)
+            Path_free(oPPrefix);
+         if (oNCurr == NULL)
+            *poNRoot = oNChild;
+      }
+      oNCurr = oNChild;
+   }
+
+   if (Dir_hasFile(oNCurr, oPPath, &ulIndex))
+      Bench_check(ALREADY_IN_TREE);
+   if (bAdopt)
+      Bench_check(File_adoptAt(oPPath, oNCurr, ulIndex, &oNFile));
+   else
+   {
+      Bench_check(File_newAt(oPPath, oNCurr, ulIndex, &oNFile));
+      Path_free(oPPath);
+   }
+}
+
+/*
+  Builds the same indexed tree of INSERT_FILES depth-6 files twice:
+  once with nodes that copy their paths, and once with nodes that
+  adopt the paths the inserts parsed. Reports the time, the number of
+  allocations path.c made for paths and the bytes they came to, and
+  how much adopting saves.
+*/
+static void Bench_insert(void)
+{
+   enum { INSERT_FILES = 200000 };
+   char acPath[MAX_PATH_LENGTH];
+   Arena_T oArena;
+   Arena_T oScratch;
+   Dir_T oNRoot;
+   size_t ulIndex;
+   size_t aulAllocs[2];
+   size_t aulBytes[2];
+   size_t ulAllocs;
+   size_t ulBytes;
+   int iAdopt;
+   double dStart;
+   double dTime;
+
+   for (iAdopt = 0; iAdopt <= 1; iAdopt++)
+   {
+      /* FT_init sets up the names, which the nodes intern */
+      Bench_check(FT_init());
+      Bench_check(FT_setIndexed(TRUE));
+      oArena = Arena_new();
+      oScratch = Arena_new();
+      if (oArena == NULL || oScratch == NULL)
+         Bench_check(MEMORY_ERROR);
+      oNRoot = NULL;
+      Path_getAllocStats(&ulAllocs, &ulBytes);
+      dStart = Bench_now();
+      for (ulIndex = 0; ulIndex < INSERT_FILES; ulIndex++)
+      {
+         sprintf(acPath, "root/a%lu/b%lu/c%lu/d/f%lu",
+                 (unsigned long)(ulIndex % 100),
+                 (unsigned long)(ulIndex % 37),
+                 (unsigned long)(ulIndex % 1000), (unsigned long)ulIndex);
+         Bench_insertNodes(oArena, oScratch, &oNRoot, acPath,
+                           (boolean)iAdopt);
+      }
+      dTime = Bench_now() - dStart;
+      Path_getAllocStats(&aulAllocs[iAdopt], &aulBytes[iAdopt]);
+      aulAllocs[iAdopt] -= ulAllocs;
+      aulBytes[iAdopt] -= ulBytes;
+      printf("insert: %d files, indexed, %s: %.3f s, %lu path "
+             "allocations of %lu bytes in all\n", INSERT_FILES,
+             iAdopt ? "adopting" : "copying", dTime,
+             (unsigned long)aulAllocs[iAdopt],
+             (unsigned long)aulBytes[iAdopt]);
+      /* FT_destroy drops the index, so the nodes can go all at once */
+      Bench_check(FT_destroy());
+      Arena_free(oArena);
+      Arena_free(oScratch);
+   }
+   printf("insert: adopting makes %.2f times the path allocations and "
+          "%.2f times the path bytes of copying\n",
+          (double)aulAllocs[1] / (double)aulAllocs[0],
+          (double)aulBytes[1] / (double)aulBytes[0]);
+}
+
+/*
+  Measures how fast paths of about 120 characters are parsed, in GB/s
+  of pathname: validated and split by PathView_init, and also made
+  into a Path_T and freed again by Path_new and Path_free.
+*/
+static void Bench_parse(void)
+{
+   enum { PATHS = 4096, PASSES = 500 };
+   static char aacPaths[PATHS][MAX_PATH_LENGTH];
+   struct pathView sView;
+   Path_T oPPath;
+   size_t ulIndex;
+   size_t ulPass;
+   size_t ulBytes = 0;
+   int iNew;
+   double dStart;
+   double dTime;
+
+   Bench_seedRandom();
+   for (ulIndex = 0; ulIndex < PATHS; ulIndex++)
+   {
+      sprintf(aacPaths[ulIndex],
+              "home/user%lu/workspace/projects/service-%lu/build/"
+              "generated/src/main/java/com/example/module%lu/internal/"
+              "Component%luImpl.java",
+              (unsigned long)(Bench_random() % 100),
+              (unsigned long)(Bench_random() % 1000),
+              (unsigned long)(Bench_random() % 100),
+              (unsigned long)ulIndex);
+      ulBytes += strlen(aacPaths[ulIndex]);
+   }
+
+   for (iNew = 0; iNew <= 1; iNew++)
+   {
+      dStart = Bench_now();
+      for (ulPass = 0; ulPass < PASSES; ulPass++)
+         for (ulIndex = 0; ulIndex < PATHS; ulIndex++)
+         {
+            if (iNew)
+            {
+               Bench_check(Path_new(aacPaths[ulIndex], &oPPath));
+               Path_free(oPPath);
+            }
+            else
+               Bench_check(PathView_init(&sView, aacPaths[ulIndex]));
+         }
+      dTime = Bench_now() - dStart;
+      printf("parse: %lu-character paths, %s: %.2f GB/s\n",
+             (unsigned long)(ulBytes / PATHS),
+             iNew ? "Path_new" : "PathView_init",
+             (double)ulBytes * PASSES / dTime / 1e9);
+   }
+}
+
+/* The names that every package of the generated tree has */
+static const char *const apcPackageFiles[] =
+{
+   "package.json", "README.md", "LICENSE", "index.js", "index.d.ts",
+   "CHANGELOG.md", ".npmignore"
+};
+static const char *const apcSourceFiles[] =
+{
+   "index.js", "utils.js", "parse.js", "types.js", "constants.js",
+   "helpers.js"
+};
+
+/* The number of top-level packages of the generated tree, and the
+   number of packages any of them has of its own, each with
+   PACKAGE_FANOUT packages of its own and so on, MAX_NESTING deep */
+enum { TOP_PACKAGES = 400, PACKAGE_FANOUT = 6, MAX_NESTING = 2 };
+
+/*
+  Adds to the generated tree the package at pcBase, with the files of
+  every package, lib and src dirs of sources, and a node_modules dir
+  of its own packages if it is less than MAX_NESTING deep. Names come
+  from a pool of TOP_PACKAGES, so that packages repeat, as they do.
+*/
+static void Bench_addPackage(const char *pcBase, int iNesting)
+{
+   char acPath[MAX_PATH_LENGTH];
+   size_t ulIndex;
+
+   for (ulIndex = 0; ulIndex < sizeof(apcPackageFiles)
+                                / sizeof(apcPackageFiles[0]); ulIndex++)
+   {
+      sprintf(acPath, "%s/%s", pcBase, apcPackageFiles[ulIndex]);
+      Bench_check(FT_insertFile(acPath, NULL, 0));
+   }
+   for (ulIndex = 0; ulIndex < sizeof(apcSourceFiles)
+                                / sizeof(apcSourceFiles[0]); ulIndex++)
+   {
+      sprintf(acPath, "%s/lib/%s", pcBase, apcSourceFiles[ulIndex]);
+      Bench_check(FT_insertFile(acPath, NULL, 0));
+      sprintf(acPath, "%s/src/%s", pcBase, apcSourceFiles[ulIndex]);
+      Bench_check(FT_insertFile(acPath, NULL, 0));
+   }
+   if (iNesting == MAX_NESTING)
+      return;
+   for (ulIndex = 0; ulIndex < PACKAGE_FANOUT; ulIndex++)
+   {
+      sprintf(acPath, "%s/node_modules/pkg-%lu", pcBase,
+              (unsigned long)(Bench_random() % TOP_PACKAGES));
+      /* a package may already be there under the same name */
+      if (!FT_containsDir(acPath))
+         Bench_addPackage(acPath, iNesting + 1);
+   }
+}
+
+/*
+  Reports the memory that the generated tree, a node_modules tree of
+  packages with the same few file names, takes: the bytes in use after
+  building it, and the bytes of names that interning saves, counting
+  each node's name with its '\0' once per node and once per distinct
+  name.
+*/
+static void Bench_names(void)
+{
+   char acPath[MAX_PATH_LENGTH];
+   struct allocStats sBefore;
+   FT_Iter_T oIter;
+   Arena_T oArena;
+   HashTable_T oHNames;
+   const char *pcPath;
+   const char *pcName;
+   char *pcCopy;
+   size_t ulIndex;
+   size_t ulLength;
+   size_t ulNodes = 0;
+   size_t ulNodeBytes = 0;
+   size_t ulDistinctBytes = 0;
+   size_t ulInUse;
+   boolean bIsFile;
+
+   Bench_check(FT_init());
+   sBefore = sAllocStats;
+   Bench_seedRandom();
+   for (ulIndex = 0; ulIndex < TOP_PACKAGES; ulIndex++)
+   {
+      sprintf(acPath, "app/node_modules/pkg-%lu", (unsigned long)ulIndex);
+      Bench_addPackage(acPath, 0);
+   }
+   ulInUse = sAllocStats.ulInUse - sBefore.ulInUse;
+
+   /* count each name once per node and once per distinct name */
+   oArena = Arena_new();
+   oHNames = HashTable_newIn(oArena, 0);
+   if (oArena == NULL || oHNames == NULL)
+      Bench_check(MEMORY_ERROR);
+   Bench_check(FT_iterBegin(&oIter));
+   while (FT_iterNext(oIter, &pcPath, &bIsFile) == SUCCESS)
+   {
+      pcName = strrchr(pcPath, '/');
+      pcName = pcName == NULL ? pcPath : pcName + 1;
+      ulLength = strlen(pcName);
+      ulNodes++;
+      ulNodeBytes += ulLength + 1;
+      if (HashTable_get(oHNames, pcName, ulLength) != NULL)
+         continue;
+      pcCopy = Arena_alloc(oArena, ulLength + 1);
+      if (pcCopy == NULL)
+         Bench_check(MEMORY_ERROR);
+      memcpy(pcCopy, pcName, ulLength);
+      if (!HashTable_put(oHNames, pcCopy, ulLength, pcCopy))
+         Bench_check(MEMORY_ERROR);
+      ulDistinctBytes += ulLength + 1;
+   }
+   FT_iterEnd(oIter);
+
+   printf("names: %lu nodes, %lu bytes in use, %.1f per node\n",
+          (unsigned long)ulNodes, (unsigned long)ulInUse,
+          (double)ulInUse / ulNodes);
+   printf("names: %lu distinct names of %lu bytes, for %lu bytes of "
+          "names node by node: %lu bytes saved\n",
+          (unsigned long)HashTable_getLength(oHNames),
+          (unsigned long)ulDistinctBytes, (unsigned long)ulNodeBytes,
+          (unsigned long)(ulNodeBytes - ulDistinctBytes));
+   HashTable_free(oHNames);
+   Arena_free(oArena);
+   Bench_check(FT_destroy());
+}
+
+/*--------------------------------------------------------------------*/
+
+/* An element of the arrays that Bench_dynArray sorts and searches */
+struct item
+{
+   unsigned int uKey;
+   char acName[12];
+};
+typedef struct item *Item_T;
+
+/* Compares oItem1 and oItem2 by key. */
+static int Item_compare(Item_T oItem1, Item_T oItem2)
+{
+   return oItem1->uKey < oItem2->uKey ? -1 : oItem1->uKey > oItem2->uKey;
+}
+
+/* Compares oItem's key with *puKey. */
+static int Item_compareKey(Item_T oItem, const unsigned int *puKey)
+{
+   return oItem->uKey < *puKey ? -1 : oItem->uKey > *puKey;
+}
+
+/* Item_compare and Item_compareKey as the DynArray functions take
+   them */
+static int Item_compareElements(const void *pvItem1, const void *pvItem2)
+{
+   return Item_compare((Item_T)pvItem1, (Item_T)pvItem2);
+}
+
+static int Item_compareElementKey(const void *pvItem, const void *pvKey)
+{
+   return Item_compareKey((Item_T)pvItem, pvKey);
+}
+
+DYNARRAY_DEFINE_SORT(ItemArray, Item_T, Item_compare)
+DYNARRAY_DEFINE_BSEARCH(ItemArray, Item_T, unsigned int, Item_compareKey)
+
+/* Puts the first ulItems of psItems in oDArray, in their order. */
+static void Bench_shuffle(DynArray_T oDArray, struct item *psItems,
+                          size_t ulItems)
+{
+   size_t ulIndex;
+
+   for (ulIndex = 0; ulIndex < ulItems; ulIndex++)
+      (void)DynArray_set(oDArray, ulIndex, &psItems[ulIndex]);
+}
+
+/*
+  Compares the generic DynArray_sort and DynArray_bsearch, which call
+  their comparison functions through pointers, with the typed sort and
+  bsearch that typedarray.h generates, which inline them, on arrays of
+  64 to 1,000,000 items. Each sort starts from the same shuffled order.
+  The generic searches then run once more with the array indexed, as
+  in a read-only phase, where DynArray_bsearch goes through its shadow
+  index once the array is long enough.
+*/
+static void Bench_dynArray(void)
+{
+   enum { MIN_ITEMS = 64, MAX_ITEMS = 1000000, WORK = 4000000 };
+   struct item *psItems;
+   DynArray_T oDArray;
+   size_t ulItems;
+   size_t ulIndex;
+   size_t ulRound;
+   size_t ulRounds;
+   size_t ulFound;
+   unsigned int uKey;
+   int iTyped;
+   int iRun;
+   double dStart;
+   double dShuffle;
+   double adTime[3];
+
+   psItems = malloc(MAX_ITEMS * sizeof(struct item));
+   oDArray = DynArray_new(0);
+   if (psItems == NULL || oDArray == NULL)
+      Bench_check(MEMORY_ERROR);
+   for (ulItems = MIN_ITEMS; ulItems <= MAX_ITEMS; ulItems *= 25)
+   {
+      ulRounds = WORK / ulItems + 1;
+      Bench_seedRandom();
+      for (ulIndex = 0; ulIndex < ulItems; ulIndex++)
+      {
+         psItems[ulIndex].uKey = (unsigned int)Bench_random();
+         if (DynArray_getLength(oDArray) < ulItems)
+            if (!DynArray_add(oDArray, &psItems[ulIndex]))
+               Bench_check(MEMORY_ERROR);
+      }
+
+      /* time the shuffling alone, to take it out of the sorts' times,
+         which are too short to time one by one */
+      dStart = Bench_now();
+      for (ulRound = 0; ulRound < ulRounds; ulRound++)
+         Bench_shuffle(oDArray, psItems, ulItems);
+      dShuffle = Bench_now() - dStart;
+      for (iTyped = 0; iTyped <= 1; iTyped++)
+      {
+         dStart = Bench_now();
+         for (ulRound = 0; ulRound < ulRounds; ulRound++)
+         {
+            Bench_shuffle(oDArray, psItems, ulItems);
+            if (iTyped)
+               ItemArray_sort(oDArray);
+            else
+               DynArray_sort(oDArray, Item_compareElements);
+         }
+         adTime[iTyped] = Bench_now() - dStart - dShuffle;
+      }
+      printf("dynArray: %lu items, sort: generic %.1f ns, typed %.1f ns "
+             "per item\n", (unsigned long)ulItems,
+             1e9 * adTime[0] / (ulRounds * ulItems),
+             1e9 * adTime[1] / (ulRounds * ulItems));
+
+      /* the runs are generic, typed, and generic on an indexed
+         array */
+      for (iRun = 0; iRun <= 2; iRun++)
+      {
+         DynArray_setIndexed(oDArray, iRun == 2);
+         ulFound = 0;
+         dStart = Bench_now();
+         for (ulRound = 0; ulRound < WORK; ulRound++)
+         {
+            uKey = psItems[ulRound * 7919 % ulItems].uKey;
+            if (iRun == 1)
+               ulFound += ItemArray_bsearch(oDArray, &uKey, &ulIndex);
+            else
+               ulFound += DynArray_bsearch(oDArray, &uKey, &ulIndex,
+                                           Item_compareElementKey);
+         }
+         adTime[iRun] = Bench_now() - dStart;
+         if (ulFound != WORK)
+            Bench_check(NO_SUCH_PATH);
+      }
+      DynArray_setIndexed(oDArray, FALSE);
+      printf("dynArray: %lu items, bsearch: generic %.1f ns, typed "
+             "%.1f ns, generic indexed %.1f ns per search\n",
+             (unsigned long)ulItems, 1e9 * adTime[0] / WORK,
+             1e9 * adTime[1] / WORK, 1e9 * adTime[2] / WORK);
+   }
+   DynArray_free(oDArray);
+   free(psItems);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Compares the name pcName in a NameArray with the name pcKey. */
+static int Name_compareKey(const char *pcName, const char *pcKey)
+{
+   return strcmp(pcName, pcKey);
+}
+
+DYNARRAY_DEFINE_SORT(NameArray, const char *, strcmp)
+DYNARRAY_DEFINE_BSEARCH(NameArray, const char *, char, Name_compareKey)
+
+/*
+  Compares a DynArray kept sorted with the typed bsearch, addAt and
+  removeAt with a BTree_T, as the list of 1,000, 100,000 and
+  10,000,000 children of one directory: the time to remove a child
+  from the middle, to add it back and to find one. Then times
+  FT_rmFile on every file of a directory of WIDE_FILES, in random
+  order, with the directory's lists in a DynArray and in a BTree.
+*/
+static void Bench_btree(void)
+{
+   enum { SIZES = 3, NAME_LENGTH = 12, WIDE_FILES = 100000 };
+   /* the numbers of children, and of each operation to time on them:
+      few at 10,000,000, where each DynArray operation moves MBs */
+   static const size_t aulChildren[SIZES] = { 1000, 100000, 10000000 };
+   static const size_t aulOps[SIZES] = { 10000, 10000, 1000 };
+   char acPath[MAX_PATH_LENGTH];
+   char *pcNames;
+   const char **ppcNames;
+   DynArray_T oDArray;
+   BTree_T oBTree;
+   size_t ulSize;
+   size_t ulChildren;
+   size_t ulKeys;
+   size_t ulOps;
+   size_t ulIndex;
+   size_t ulAt;
+   size_t ulDone;
+   size_t ulFound;
+   int iTree;
+   double dStart;
+   double adTime[3];
+
+   ulChildren = aulChildren[SIZES - 1];
+   pcNames = malloc(ulChildren * NAME_LENGTH);
+   ppcNames = malloc(ulChildren * sizeof(const char *));
+   if (pcNames == NULL || ppcNames == NULL)
+      Bench_check(MEMORY_ERROR);
+   /* distinct names in random order: 2654435761 is prime, so each
+      index gives a different remainder */
+   for (ulIndex = 0; ulIndex < ulChildren; ulIndex++)
+   {
+      ppcNames[ulIndex] = pcNames + ulIndex * NAME_LENGTH;
+      sprintf(pcNames + ulIndex * NAME_LENGTH, "f%lx",
+              (unsigned long)(ulIndex * 40503UL % 2654435761UL));
+   }
+
+   for (ulSize = 0; ulSize < SIZES; ulSize++)
+   {
+      ulChildren = aulChildren[ulSize];
+      /* the same keys go out and back in, a tenth of the list at most */
+      ulKeys = ulChildren / 10 < aulOps[ulSize] ? ulChildren / 10
+                                                : aulOps[ulSize];
+      ulOps = aulOps[ulSize];
+      for (iTree = 0; iTree <= 1; iTree++)
+      {
+         oDArray = NULL;
+         oBTree = NULL;
+         if (iTree)
+         {
+            oBTree = BTree_new();
+            if (oBTree == NULL)
+               Bench_check(MEMORY_ERROR);
+            for (ulIndex = 0; ulIndex < ulChildren; ulIndex++)
+               if (!BTree_put(oBTree, ppcNames[ulIndex], ppcNames[ulIndex]))
+                  Bench_check(MEMORY_ERROR);
+         }
+         else
+         {
+            /* appending and sorting once builds it in O(n log n) */
+            oDArray = DynArray_new(0);
+            if (oDArray == NULL)
+               Bench_check(MEMORY_ERROR);
+            for (ulIndex = 0; ulIndex < ulChildren; ulIndex++)
+               if (!DynArray_add(oDArray, ppcNames[ulIndex]))
+                  Bench_check(MEMORY_ERROR);
+            NameArray_sort(oDArray);
+         }
+
+         /* remove, add back, then find ulKeys children at a time */
+         adTime[0] = adTime[1] = adTime[2] = 0;
+         ulFound = 0;
+         for (ulDone = 0; ulDone < ulOps; ulDone += ulKeys)
+         {
+            dStart = Bench_now();
+            for (ulIndex = 0; ulIndex < ulKeys; ulIndex++)
+               if (iTree)
+                  ulFound += BTree_remove(oBTree, ppcNames[ulIndex]) != NULL;
+               else if (NameArray_bsearch(oDArray, ppcNames[ulIndex],
+                                          &ulAt))
+               {
+                  (void)DynArray_removeAt(oDArray, ulAt);
+                  ulFound++;
+               }
+            adTime[0] += Bench_now() - dStart;
+
+            dStart = Bench_now();
+            for (ulIndex = 0; ulIndex < ulKeys; ulIndex++)
+               if (iTree)
+               {
+                  if (!BTree_put(oBTree, ppcNames[ulIndex],
+                                 ppcNames[ulIndex]))
+                     Bench_check(MEMORY_ERROR);
+               }
+               else
+               {
+                  (void)NameArray_bsearch(oDArray, ppcNames[ulIndex],
+                                          &ulAt);
+                  if (!DynArray_addAt(oDArray, ulAt,
+                                      ppcNames[ulIndex]))
+                     Bench_check(MEMORY_ERROR);
+               }
+            adTime[1] += Bench_now() - dStart;
+
+            dStart = Bench_now();
+            for (ulIndex = 0; ulIndex < ulKeys; ulIndex++)
+               if (iTree)
+                  ulFound += BTree_search(oBTree, ppcNames[ulIndex],
+                                          &ulAt);
+               else
+                  ulFound += NameArray_bsearch(oDArray, ppcNames[ulIndex],
+                                               &ulAt);
+            adTime[2] += Bench_now() - dStart;
+         }
+         if (ulFound != 2 * ulDone)
+            Bench_check(NO_SUCH_PATH);
+         printf("btree: %lu children, %s: remove %.1f ns, add %.1f ns, "
+                "search %.1f ns\n", (unsigned long)ulChildren,
+                iTree ? "BTree" : "DynArray", 1e9 * adTime[0] / ulDone,
+                1e9 * adTime[1] / ulDone, 1e9 * adTime[2] / ulDone);
+         if (iTree)
+            BTree_free(oBTree);
+         else
+            DynArray_free(oDArray);
+      }
+   }
+
+   /* then through FT, where a wide DynArray list is hashed and only
+      sorted again to remove a child */
+   for (iTree = 0; iTree <= 1; iTree++)
+   {
+      Bench_check(FT_init());
+      Dir_setBTreeLists((boolean)iTree);
+      for (ulIndex = 0; ulIndex < WIDE_FILES; ulIndex++)
+      {
+         sprintf(acPath, "root/dir/%s", ppcNames[ulIndex]);
+         Bench_check(FT_insertFile(acPath, NULL, 0));
+      }
+      dStart = Bench_now();
+      for (ulIndex = 0; ulIndex < WIDE_FILES; ulIndex++)
+      {
+         sprintf(acPath, "root/dir/%s", ppcNames[ulIndex]);
+         Bench_check(FT_rmFile(acPath));
+      }
+      adTime[0] = Bench_now() - dStart;
+      printf("btree: FT_rmFile on %d files of one directory, %s lists: "
+             "%.3f s\n", WIDE_FILES, iTree ? "BTree" : "DynArray",
+             adTime[0]);
+      Dir_setBTreeLists(FALSE);
+      Bench_check(FT_destroy());
+   }
+
+   free(ppcNames);
+   free(pcNames);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A benchmark, and the name to run it by */
+struct bench
+{
+   const char *pcName;
+   void (*pfRun)(void);
+};
+
+static const struct bench asBenches[] =
+{
+   {"btree", Bench_btree},
+   {"dynArray", Bench_dynArray},
+   {"index", Bench_index},
+   {"insert", Bench_insert},
+   {"lookup", Bench_lookup},
+   {"names", Bench_names},
+   {"parse", Bench_parse},
+   {"rm", Bench_rm},
+   {"toString", Bench_toString}
+};
+
+/* The number of benchmarks in asBenches */
+enum { BENCH_COUNT = sizeof(asBenches) / sizeof(asBenches[0]) };
+
+/*
+  Runs the benchmarks named in argv, or all of them if there are none.
+  Returns 0, or 1 if a name is not a benchmark's.
+*/
+int main(int argc, char *argv[])
+{
+   int iArg;
+   size_t ulBench;
+
+   if (argc == 1)
+   {
+      for (ulBench = 0; ulBench < BENCH_COUNT; ulBench++)
+         (*asBenches[ulBench].pfRun)();
+      return 0;
+   }
+
+   for (iArg = 1; iArg < argc; iArg++)
+   {
+      for (ulBench = 0; ulBench < BENCH_COUNT; ulBench++)
+         if (strcmp(argv[iArg], asBenches[ulBench].pcName) == 0)
+            break;
+      if (ulBench == BENCH_COUNT)
+      {
+         fprintf(stderr, "%s: no benchmark named %s\n", argv[0],
+                 argv[iArg]);
+         return 1;
+      }
+      (*asBenches[ulBench].pfRun)();
+   }
+   return 0;
+}
@@ -0,0 +1,252 @@
+/*--------------------------------------------------------------------*/
+/* nameTable.c                                                        */
+/* Author: Roy Mazumder and Roshaan Khalid                            */
+/*--------------------------------------------------------------------*/
+
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include "a4def.h"
+#include "arena.h"
+#include "hashtable.h"
+#include "nameTable.h"
+
+/* An interned name. Its characters follow it in the same block,
+   '\0'-terminated. */
+struct symbol
+{
+   /* the string length and HashTable_hash of the name */
+   size_t ulLength;
+   size_t uHash;
+   /* the number of nodes with the name */
+   size_t ulRefCount;
+   /* the name's id, its index in psSlots */
+   unsigned int uId;
+};
+
+/* An entry of the id table: the symbol with that id, or, if the id is
+   free, the next free id */
+union slot
+{
+   struct symbol *psSymbol;
+   unsigned int uNextFree;
+};
+
+/* The number of slots the id table starts with */
+enum {MIN_SLOTS = 64};
+
+/*
+  The table is an AO with 6 state variables. Symbols are found by
+  name through oHSymbols, keyed by their own characters, and by id
+  through psSlots, whose free ids form a list.
+*/
+
+/* 1. the arena everything comes from, or NULL for the heap */
+static Arena_T oArena;
+/* 2. the map from names to symbols, or NULL until the first name */
+static HashTable_T oHSymbols;
+/* 3. the id table */
+static union slot *psSlots;
+/* 4. the number of slots in psSlots */
+static unsigned int uSlots;
+/* 5. the number of slots ever used, free or not */
+static unsigned int uUsed;
+/* 6. the first free id among them, or NAMETABLE_NONE */
+static unsigned int uFirstFree;
+
+/* Returns the characters of psSymbol's name. */
+static const char *NameTable_getChars(const struct symbol *psSymbol)
+{
+   assert(psSymbol != NULL);
+
+   return (const char *)(psSymbol + 1);
+}
+
+/* Returns the symbol with id uId, which must be in the table. */
+static struct symbol *NameTable_getSymbol(unsigned int uId)
+{
+   assert(uId < uUsed);
+   assert(psSlots[uId].psSymbol != NULL);
+
+   return psSlots[uId].psSymbol;
+}
+
+/*
+  Returns a free id, taking a new slot if none is free, or
+  NAMETABLE_NONE if memory could not be allocated for one.
+*/
+static unsigned int NameTable_takeId(void)
+{
+   union slot *psNewSlots;
+   unsigned int uNewSlots;
+   unsigned int uId;
+
+   if (uFirstFree != NAMETABLE_NONE)
+   {
+      uId = uFirstFree;
+      uFirstFree = psSlots[uId].uNextFree;
+      return uId;
+   }
+
+   if (uUsed == uSlots)
+   {
+      /* ids must stay below NAMETABLE_NONE */
+      if (uSlots > NAMETABLE_NONE / 2)
+         return NAMETABLE_NONE;
+      uNewSlots = uSlots == 0 ? MIN_SLOTS : 2 * uSlots;
+      psNewSlots = Arena_alloc(oArena, uNewSlots * sizeof(union slot));
+      if (psNewSlots == NULL)
+         return NAMETABLE_NONE;
+      if (psSlots != NULL)
+      {
+         memcpy(psNewSlots, psSlots, uSlots * sizeof(union slot));
+         Arena_release(oArena, psSlots, uSlots * sizeof(union slot));
+      }
+      psSlots = psNewSlots;
+      uSlots = uNewSlots;
+   }
+   return uUsed++;
+}
+
+/* Makes uId, which no symbol has any more, free. */
+static void NameTable_giveId(unsigned int uId)
+{
+   assert(uId < uUsed);
+
+   psSlots[uId].uNextFree = uFirstFree;
+   uFirstFree = uId;
+}
+
+void NameTable_init(Arena_T oArenaToUse)
+{
+   oArena = oArenaToUse;
+   oHSymbols = NULL;
+   psSlots = NULL;
+   uSlots = 0;
+   uUsed = 0;
+   uFirstFree = NAMETABLE_NONE;
+}
+
+void NameTable_makeKey(struct nameKey *psKey, const char *pcName,
+                       size_t ulLength, size_t uHash)
+{
+   assert(psKey != NULL);
+   assert(pcName != NULL);
+
+   psKey->pcName = pcName;
+   psKey->ulLength = ulLength;
+   psKey->uHash = uHash;
+   psKey->uId = NAMETABLE_NONE;
+}
+
+void NameTable_getKey(unsigned int uId, struct nameKey *psKey)
+{
+   const struct symbol *psSymbol = NameTable_getSymbol(uId);
+
+   assert(psKey != NULL);
+
+   psKey->pcName = NameTable_getChars(psSymbol);
+   psKey->ulLength = psSymbol->ulLength;
+   psKey->uHash = psSymbol->uHash;
+   psKey->uId = uId;
+}
+
+const char *NameTable_getString(unsigned int uId)
+{
+   return NameTable_getChars(NameTable_getSymbol(uId));
+}
+
+int NameTable_compareKey(const char *pcName, unsigned int uId,
+                         const struct nameKey *psKey)
+{
+   int iResult;
+
+   assert(pcName != NULL);
+   assert(psKey != NULL);
+
+   if (uId == psKey->uId)
+      return 0;
+
+   iResult = strncmp(pcName, psKey->pcName, psKey->ulLength);
+   if (iResult != 0)
+      return iResult;
+   /* pcName starts with the key, so it is greater unless it ends */
+   return pcName[psKey->ulLength] != '\0';
+}
+
+int NameTable_intern(const struct nameKey *psKey, unsigned int *puId)
+{
+   struct symbol *psSymbol;
+   unsigned int uId;
+
+   assert(psKey != NULL);
+   assert(puId != NULL);
+
+   if (psKey->uId != NAMETABLE_NONE)
+      psSymbol = NameTable_getSymbol(psKey->uId);
+   else if (oHSymbols != NULL)
+      psSymbol = HashTable_getHashed(oHSymbols, psKey->pcName,
+                                     psKey->ulLength, psKey->uHash);
+   else
+   {
+      oHSymbols = HashTable_newIn(oArena, 0);
+      if (oHSymbols == NULL)
+         return MEMORY_ERROR;
+      psSymbol = NULL;
+   }
+   if (psSymbol != NULL)
+   {
+      psSymbol->ulRefCount++;
+      *puId = psSymbol->uId;
+      return SUCCESS;
+   }
+
+   psSymbol = Arena_alloc(oArena,
+                          sizeof(struct symbol) + psKey->ulLength + 1);
+   if (psSymbol == NULL)
+      return MEMORY_ERROR;
+   /* Arena_alloc zeroes the block, so the copy is terminated */
+   memcpy(psSymbol + 1, psKey->pcName, psKey->ulLength);
+   psSymbol->ulLength = psKey->ulLength;
+   psSymbol->uHash = psKey->uHash;
+   psSymbol->ulRefCount = 1;
+
+   uId = NameTable_takeId();
+   if (uId == NAMETABLE_NONE)
+   {
+      Arena_release(oArena, psSymbol,
+                    sizeof(struct symbol) + psKey->ulLength + 1);
+      return MEMORY_ERROR;
+   }
+   if (!HashTable_putHashed(oHSymbols, NameTable_getChars(psSymbol),
+                            psSymbol->ulLength, psSymbol->uHash,
+                            psSymbol))
+   {
+      NameTable_giveId(uId);
+      Arena_release(oArena, psSymbol,
+                    sizeof(struct symbol) + psKey->ulLength + 1);
+      return MEMORY_ERROR;
+   }
+   psSymbol->uId = uId;
+   psSlots[uId].psSymbol = psSymbol;
+
+   *puId = uId;
+   return SUCCESS;
+}
+
+void NameTable_release(unsigned int uId)
+{
+   struct symbol *psSymbol = NameTable_getSymbol(uId);
+
+   assert(psSymbol->ulRefCount > 0);
+
+   psSymbol->ulRefCount--;
+   if (psSymbol->ulRefCount > 0)
+      return;
+
+   (void)HashTable_removeHashed(oHSymbols, NameTable_getChars(psSymbol),
+                                psSymbol->ulLength, psSymbol->uHash);
+   NameTable_giveId(uId);
+   Arena_release(oArena, psSymbol,
+                 sizeof(struct symbol) + psSymbol->ulLength + 1);
+}
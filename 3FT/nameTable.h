@@ -0,0 +1,80 @@
+/*--------------------------------------------------------------------*/
+/* nameTable.h                                                        */
+/* Author: Roy Mazumder and Roshaan Khalid                            */
+/*--------------------------------------------------------------------*/
+
+#ifndef NAMETABLE_INCLUDED
+#define NAMETABLE_INCLUDED
+
+/*
+  The name table interns the names of the nodes in the File Tree, so
+  that each distinct name is stored once however many nodes have it.
+  Each node holds the 32-bit id of its name instead of a copy, and two
+  interned names are equal if and only if their ids are.
+*/
+
+#include <stddef.h>
+#include "a4def.h"
+#include "arena.h"
+
+/* The id of a name not known to be in the table */
+#define NAMETABLE_NONE 0xFFFFFFFFU
+
+/*
+  A name as lookups see it. pcName need not be '\0'-terminated, uHash
+  is its HashTable_hash, and uId is its id, or NAMETABLE_NONE if it is
+  not known to be in the table. Two keys with ids stand for the same
+  name if and only if their ids are equal.
+*/
+struct nameKey
+{
+   const char *pcName;
+   size_t ulLength;
+   size_t uHash;
+   unsigned int uId;
+};
+
+/*
+  Starts the table out empty, taking its memory from oArena, which must
+  outlive it: the table is freed by freeing oArena. Whatever the table
+  held is forgotten rather than freed, which is all there is to do
+  once its arena is gone. oArena is NULL only while there is no FT,
+  so that the table holds nothing that outlives the last one.
+*/
+void NameTable_init(Arena_T oArena);
+
+/*
+  Sets *psKey to the ulLength characters at pcName, whose HashTable_hash
+  is uHash, without looking them up in the table.
+*/
+void NameTable_makeKey(struct nameKey *psKey, const char *pcName,
+                       size_t ulLength, size_t uHash);
+
+/* Sets *psKey to the name with id uId, which must be in the table. */
+void NameTable_getKey(unsigned int uId, struct nameKey *psKey);
+
+/* Returns the name with id uId, which must be in the table. */
+const char *NameTable_getString(unsigned int uId);
+
+/*
+  Compares pcName, the name with id uId, with the name psKey stands
+  for, as strcmp would compare them as strings. Equal names have equal
+  ids, so only names that differ are read, to order them.
+*/
+int NameTable_compareKey(const char *pcName, unsigned int uId,
+                         const struct nameKey *psKey);
+
+/*
+  Adds a reference to the name psKey stands for, adding the name if it
+  is not in the table yet, and sets *puId to its id. Returns SUCCESS,
+  or MEMORY_ERROR if memory could not be allocated to complete request.
+*/
+int NameTable_intern(const struct nameKey *psKey, unsigned int *puId);
+
+/*
+  Gives up a reference to the name with id uId, which is removed once
+  no node has it.
+*/
+void NameTable_release(unsigned int uId);
+
+#endif
@@ -0,0 +1,138 @@
+/*--------------------------------------------------------------------*/
+/* nodeIndex.c                                                        */
+/* Author: Roy Mazumder and Roshaan Khalid                            */
+/*--------------------------------------------------------------------*/
+
+#include <stddef.h>
+#include <assert.h>
+#include "a4def.h"
+#include "hashtable.h"
+#include "path.h"
+#include "dirNode.h"
+#include "fileNode.h"
+#include "nodeIndex.h"
+
+/*
+  The index is an AO with 2 state variables, one table per node type
+  (a pathname is never both a directory and a file), which are NULL
+  while the index is disabled. Each key is borrowed from the characters
+  of the node's cached Path_T, which lives exactly as long as the node.
+  Nodes only build that cache on demand, so the index never asks for a
+  path while it is disabled.
+*/
+
+/* 1. the map from directory pathnames to Dir_T nodes */
+static HashTable_T oHDirs;
+/* 2. the map from file pathnames to File_T nodes */
+static HashTable_T oHFiles;
+
+int NodeIndex_enable(void)
+{
+   if (oHDirs != NULL)
+      return SUCCESS;
+
+   oHDirs = HashTable_new(0);
+   oHFiles = HashTable_new(0);
+   if (oHDirs == NULL || oHFiles == NULL)
+   {
+      NodeIndex_disable();
+      return MEMORY_ERROR;
+   }
+   return SUCCESS;
+}
+
+void NodeIndex_disable(void)
+{
+   if (oHDirs != NULL)
+      HashTable_free(oHDirs);
+   if (oHFiles != NULL)
+      HashTable_free(oHFiles);
+   oHDirs = NULL;
+   oHFiles = NULL;
+}
+
+boolean NodeIndex_isEnabled(void)
+{
+   return (boolean)(oHDirs != NULL);
+}
+
+/*
+  Binds oPPath's pathname to pvNode in oHTable. Returns SUCCESS, or
+  MEMORY_ERROR if oPPath is NULL because the node's path could not be
+  built, or if memory could not be allocated to complete request.
+*/
+static int NodeIndex_add(HashTable_T oHTable, Path_T oPPath,
+                         const void *pvNode)
+{
+   assert(oHTable != NULL);
+   assert(pvNode != NULL);
+
+   if (oPPath == NULL)
+      return MEMORY_ERROR;
+   if (!HashTable_put(oHTable, Path_getChars(oPPath),
+                      Path_getStrLength(oPPath), pvNode))
+      return MEMORY_ERROR;
+   return SUCCESS;
+}
+
+/* Unbinds oPPath's pathname in oHTable, if oPPath is not NULL. */
+static void NodeIndex_remove(HashTable_T oHTable, Path_T oPPath)
+{
+   assert(oHTable != NULL);
+
+   if (oPPath != NULL)
+      (void)HashTable_remove(oHTable, Path_getChars(oPPath),
+                             Path_getStrLength(oPPath));
+}
+
+int NodeIndex_addDir(Dir_T oNDir)
+{
+   assert(oNDir != NULL);
+
+   if (oHDirs == NULL)
+      return SUCCESS;
+   return NodeIndex_add(oHDirs, Dir_getPath(oNDir), oNDir);
+}
+
+int NodeIndex_addFile(File_T oNFile)
+{
+   assert(oNFile != NULL);
+
+   if (oHFiles == NULL)
+      return SUCCESS;
+   return NodeIndex_add(oHFiles, File_getPath(oNFile), oNFile);
+}
+
+void NodeIndex_removeDir(Dir_T oNDir)
+{
+   assert(oNDir != NULL);
+
+   if (oHDirs != NULL)
+      NodeIndex_remove(oHDirs, Dir_getPath(oNDir));
+}
+
+void NodeIndex_removeFile(File_T oNFile)
+{
+   assert(oNFile != NULL);
+
+   if (oHFiles != NULL)
+      NodeIndex_remove(oHFiles, File_getPath(oNFile));
+}
+
+Dir_T NodeIndex_getDir(const char *pcPath, size_t ulLength)
+{
+   assert(pcPath != NULL);
+
+   if (oHDirs == NULL)
+      return NULL;
+   return HashTable_get(oHDirs, pcPath, ulLength);
+}
+
+File_T NodeIndex_getFile(const char *pcPath, size_t ulLength)
+{
+   assert(pcPath != NULL);
+
+   if (oHFiles == NULL)
+      return NULL;
+   return HashTable_get(oHFiles, pcPath, ulLength);
+}
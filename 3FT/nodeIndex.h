@@ -0,0 +1,52 @@
+/*--------------------------------------------------------------------*/
+/* nodeIndex.h                                                        */
+/* Author: Roy Mazumder and Roshaan Khalid                            */
+/*--------------------------------------------------------------------*/
+
+#ifndef NODEINDEX_INCLUDED
+#define NODEINDEX_INCLUDED
+
+/*
+  The node index is an optional map from the full pathname of every
+  node in the File Tree to that node. While it is enabled, Dir_new,
+  File_new, Dir_free and File_free keep it up to date, so an exact-path
+  lookup costs O(1) expected time instead of a walk from the root.
+*/
+
+#include <stddef.h>
+#include "a4def.h"
+#include "dirNode.h"
+#include "fileNode.h"
+
+/*
+  Enables the index, which starts out empty. Returns SUCCESS, or
+  MEMORY_ERROR if memory could not be allocated to complete request.
+  Enabling an enabled index has no effect.
+*/
+int NodeIndex_enable(void);
+
+/* Disables the index and frees all memory allocated for it. */
+void NodeIndex_disable(void);
+
+/* Returns TRUE if the index is enabled, and FALSE if not. */
+boolean NodeIndex_isEnabled(void);
+
+/*
+  Adds oNDir (or oNFile) to the index, if enabled. Returns SUCCESS, or
+  MEMORY_ERROR if memory could not be allocated to complete request.
+*/
+int NodeIndex_addDir(Dir_T oNDir);
+int NodeIndex_addFile(File_T oNFile);
+
+/* Removes oNDir (or oNFile) from the index, if enabled. */
+void NodeIndex_removeDir(Dir_T oNDir);
+void NodeIndex_removeFile(File_T oNFile);
+
+/*
+  Returns the directory (or file) whose pathname is the ulLength bytes
+  at pcPath, or NULL if there is none or the index is disabled.
+*/
+Dir_T NodeIndex_getDir(const char *pcPath, size_t ulLength);
+File_T NodeIndex_getFile(const char *pcPath, size_t ulLength);
+
+#endif